@@ -20,34 +20,24 @@ public:
         circle2 = (new ts::Circle(500, 200, 50))->addTexture("Textures/awesomeface.png", true);
         line = (new ts::Line(1600, 0, 1600, 1080))->setColor(sf::Color::Yellow)->setThickness(10.0f);
         text = (new ts::Text(1680, 0, "A glorious Text!"))->setColor(sf::Color::Green);
-        Renderer::addBackground("Textures/game-background-hills.jpg", true);//although called last, has priority 0 => is background
+        Renderer::addBackground("Textures/game-background-hills.jpg", true);//although called last, it is on the background layer => drawn behind everything else
+
+        //animations run in the rendering thread, update() doesn't have to move anything itself
+        Renderer::addTween(ts::Tween::move(rect, 300, 0, sf::seconds(5.0f)).setStartValue(10, 0).setLoops(-1, true));
+        Renderer::addTween(ts::Tween::move(rect2, 300, 100, sf::seconds(5.0f)).setStartValue(10, 100).setLoops(-1, true));
+        Renderer::addTween(ts::Tween::radius(circle2, 0, sf::seconds(5.0f)).setStartValue(290, 290).setLoops(-1, true));
+        uint64_t toMagenta = Renderer::addTween(ts::Tween::recolor(rect2, sf::Color::Magenta, sf::seconds(2.0f)).setEasing(ts::Easing::SineInOut).setDelay(sf::seconds(1.0f)));
+        Renderer::addTween(ts::Tween::fade(rect2, 128, sf::seconds(2.0f)).setEasing(ts::Easing::SineInOut).setLoops(-1, true).startAfter(toMagenta));
     }
    
-    float x = 0.0f;
-    bool goRight = true;
+    unsigned int ticks = 0;
     void update() {
-        if (goRight) {
-            x++;
-        }
-        else {
-            x--;
-        }
-        if (x >= 300) {
-            goRight = false;
-            //check if deleting a shape removes it from the renderer properly
-            if (circle != nullptr) {
-                delete circle;
-                circle = nullptr;
-            }
-
-        }
-        else if (x <= 10) {
-            goRight = true;
+        ticks++;
+        //check if deleting a shape removes it from the renderer properly
+        if (ticks == 300 && circle != nullptr) {
+            delete circle;
+            circle = nullptr;
         }
-        //  circle->setRadius(x);
-        circle2->setRadius(300 - x);
-        rect->transform(x, 0);
-        rect2->transform(x, 100);
     }
 };
 
@@ -60,5 +50,11 @@ int main() {
     Renderer::init();
     events = new Events{};
     Renderer::startEventloop(&callbackHelp);
+#ifdef TS_PROFILER
+    Profiler::writeChromeTrace("trace.json");//open in chrome://tracing or ui.perfetto.dev
+#endif
+#ifdef TS_LOCK_PROFILER
+    LockProfiler::report();
+#endif
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include "Camera.hpp"
+#include "Renderer.hpp"
+
+void ts::Camera::reset(sf::Vector2f viewportSize) {
+	mtx.lock();
+	this->viewportSize = viewportSize;
+	center = viewportSize / 2.0f;
+	zoomFactor = 1.0f;
+	rotation = 0.0f;
+	mtx.unlock();
+	changed();
+}
+
+void ts::Camera::setCenter(float x, float y) {
+	mtx.lock();
+	center = sf::Vector2f(x, y);
+	mtx.unlock();
+	changed();
+}
+
+void ts::Camera::move(float x, float y) {
+	mtx.lock();
+	center += sf::Vector2f(x, y);
+	mtx.unlock();
+	changed();
+}
+
+sf::Vector2f ts::Camera::getCenter() {
+	mtx.lock();
+	sf::Vector2f temp = center;
+	mtx.unlock();
+	return temp;
+}
+
+void ts::Camera::setZoom(float zoom) {
+	if (zoom <= 0.0f) {
+		return;
+	}
+	mtx.lock();
+	zoomFactor = zoom;
+	mtx.unlock();
+	changed();
+}
+
+void ts::Camera::zoom(float factor) {
+	if (factor <= 0.0f) {
+		return;
+	}
+	mtx.lock();
+	zoomFactor *= factor;
+	mtx.unlock();
+	changed();
+}
+
+float ts::Camera::getZoom() {
+	mtx.lock();
+	float temp = zoomFactor;
+	mtx.unlock();
+	return temp;
+}
+
+void ts::Camera::setRotation(float degrees) {
+	mtx.lock();
+	rotation = std::fmod(degrees, 360.0f);
+	mtx.unlock();
+	changed();
+}
+
+void ts::Camera::rotate(float degrees) {
+	mtx.lock();
+	rotation = std::fmod(rotation + degrees, 360.0f);
+	mtx.unlock();
+	changed();
+}
+
+float ts::Camera::getRotation() {
+	mtx.lock();
+	float temp = rotation;
+	mtx.unlock();
+	return temp;
+}
+
+sf::View ts::Camera::buildView() {
+	sf::View view(center, viewportSize / zoomFactor);
+	view.setRotation(rotation);
+	return view;
+}
+
+sf::View ts::Camera::getView() {
+	mtx.lock();
+	sf::View view = buildView();
+	mtx.unlock();
+	return view;
+}
+
+sf::FloatRect ts::Camera::getWorldBounds() {
+	//the view maps the visible area to -1..1
+	return getView().getInverseTransform().transformRect(sf::FloatRect(-1.0f, -1.0f, 2.0f, 2.0f));
+}
+
+sf::Vector2f ts::Camera::mapPixelToWorld(sf::Vector2i pixel) {
+	mtx.lock();
+	sf::View view = buildView();
+	sf::Vector2f size = viewportSize;
+	mtx.unlock();
+	sf::Vector2f normalized(2.0f * pixel.x / size.x - 1.0f, 1.0f - 2.0f * pixel.y / size.y);
+	return view.getInverseTransform().transformPoint(normalized);
+}
+
+sf::Vector2i ts::Camera::mapWorldToPixel(sf::Vector2f point) {
+	mtx.lock();
+	sf::View view = buildView();
+	sf::Vector2f size = viewportSize;
+	mtx.unlock();
+	sf::Vector2f normalized = view.getTransform().transformPoint(point);
+	return sf::Vector2i((int)std::floor((normalized.x + 1.0f) / 2.0f * size.x), (int)std::floor((1.0f - normalized.y) / 2.0f * size.y));
+}
+
+void ts::Camera::changed() {
+	version.fetch_add(1, std::memory_order_acq_rel);
+	Renderer::requestRedraw();
+}
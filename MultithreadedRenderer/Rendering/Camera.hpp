@@ -0,0 +1,62 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include "SFML/Graphics.hpp"
+#include "LockProfiler.hpp"
+
+namespace ts {
+	/** The part of the world that is shown in the window. Pans, zooms and rotates everything that is drawn, backed by an sf::View.
+	* Positions of drawables are world coordinates, at zoom 1 without panning or rotation they are window pixels.
+	* Can be changed from any thread, the rendering thread picks up the state at the start of every frame. Use the one of Renderer::getCamera().
+	* Mouse positions stay in window pixels, convert them with mapPixelToWorld.*/
+	class Camera {
+	public:
+		Camera() {}
+		Camera(const Camera&) = delete;
+
+		/* Shows "viewportSize" world units at zoom 1, centered on the middle of that area like the default view of the window. */
+		void reset(sf::Vector2f viewportSize);
+
+		/* The world point shown in the middle of the window */
+		void setCenter(float x, float y);
+		void move(float x, float y);
+		sf::Vector2f getCenter();
+
+		/* 2 shows everything twice as big, 0.5 half as big */
+		void setZoom(float zoom);
+		/* Multiplies the zoom with "factor" */
+		void zoom(float factor);
+		float getZoom();
+
+		/* Rotation of the view in degrees, the world turns the other way on screen */
+		void setRotation(float degrees);
+		void rotate(float degrees);
+		float getRotation();
+
+		sf::View getView();
+		/* Axis aligned bounds of the world area that is visible */
+		sf::FloatRect getWorldBounds();
+
+		/* Where the window pixel "pixel" is in the world, e.g. to find what the mouse points at */
+		sf::Vector2f mapPixelToWorld(sf::Vector2i pixel);
+		sf::Vector2i mapWorldToPixel(sf::Vector2f point);
+
+		/* Incremented by every change, lets the Renderer notice that the whole window has to be redrawn */
+		uint64_t getVersion() {
+			return version.load(std::memory_order_acquire);
+		}
+
+	private:
+		ProfiledMutex mtx{ "Camera::mtx" };
+		sf::Vector2f viewportSize = sf::Vector2f(1920.0f, 1080.0f);
+		sf::Vector2f center = sf::Vector2f(960.0f, 540.0f);
+		float zoomFactor = 1.0f;
+		float rotation = 0.0f;
+		std::atomic<uint64_t> version = 0;
+
+		/* Call with mtx locked */
+		sf::View buildView();
+		/* Call after every change, with mtx unlocked */
+		void changed();
+	};
+}
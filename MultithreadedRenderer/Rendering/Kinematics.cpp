@@ -0,0 +1,81 @@
+#include "Kinematics.hpp"
+#include <cmath>
+
+int KinematicSystem::add(ts::Drawable* owner, sf::Vector2f position, float rotation) {
+	if (owners.empty() == true) {//nothing moved since the last integration, don't let the first one jump
+		restartClock = true;
+	}
+	owners.push_back(owner);
+	x.push_back(position.x);
+	y.push_back(position.y);
+	vx.push_back(0.0f);
+	vy.push_back(0.0f);
+	ax.push_back(0.0f);
+	ay.push_back(0.0f);
+	this->rotation.push_back(rotation);
+	angularVelocity.push_back(0.0f);
+	return (int)owners.size() - 1;
+}
+
+ts::Drawable* KinematicSystem::remove(int slot) {
+	size_t last = owners.size() - 1;
+	ts::Drawable* moved = nullptr;
+	if ((size_t)slot != last) {
+		owners[slot] = owners[last];
+		x[slot] = x[last];
+		y[slot] = y[last];
+		vx[slot] = vx[last];
+		vy[slot] = vy[last];
+		ax[slot] = ax[last];
+		ay[slot] = ay[last];
+		rotation[slot] = rotation[last];
+		angularVelocity[slot] = angularVelocity[last];
+		moved = owners[slot];
+	}
+	owners.pop_back();
+	x.pop_back();
+	y.pop_back();
+	vx.pop_back();
+	vy.pop_back();
+	ax.pop_back();
+	ay.pop_back();
+	rotation.pop_back();
+	angularVelocity.pop_back();
+	return moved;
+}
+
+void KinematicSystem::setMotion(int slot, sf::Vector2f velocity, sf::Vector2f acceleration, float angularVelocity) {
+	vx[slot] = velocity.x;
+	vy[slot] = velocity.y;
+	ax[slot] = acceleration.x;
+	ay[slot] = acceleration.y;
+	this->angularVelocity[slot] = angularVelocity;
+}
+
+void KinematicSystem::integrate(double now) {
+	const float dt = restartClock == true ? 0.0f : (float)(now - lastIntegration);
+	lastIntegration = now;
+	restartClock = false;
+	const float halfDtSquared = 0.5f * dt * dt;
+	const size_t count = owners.size();
+
+	//exact for constant acceleration, so the result doesn't depend on the framerate
+	float* px = x.data(), * py = y.data(), * pvx = vx.data(), * pvy = vy.data(), * pax = ax.data(), * pay = ay.data();
+	for (size_t i = 0; i < count; i++) {
+		px[i] += pvx[i] * dt + pax[i] * halfDtSquared;
+	}
+	for (size_t i = 0; i < count; i++) {
+		py[i] += pvy[i] * dt + pay[i] * halfDtSquared;
+	}
+	for (size_t i = 0; i < count; i++) {
+		pvx[i] += pax[i] * dt;
+	}
+	for (size_t i = 0; i < count; i++) {
+		pvy[i] += pay[i] * dt;
+	}
+	float* rot = rotation.data(), * angular = angularVelocity.data();
+	for (size_t i = 0; i < count; i++) {
+		rot[i] += angular[i] * dt;
+		rot[i] -= 360.0f * std::floor(rot[i] / 360.0f);//keep it small, floats lose precision for large angles
+	}
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#pragma once
+#include <vector>
+#include "SFML/Graphics.hpp"
+
+namespace ts {
+	class Drawable;
+
+	//Position, velocity and rotation of a moving drawable at one point in time
+	struct MotionState {
+		sf::Vector2f position;
+		sf::Vector2f velocity;
+		float rotation = 0.0f;
+	};
+}
+
+/** Moves drawables with constant acceleration and angular velocity. Every component is stored in its own array (structure of arrays),
+* so that integrate() is a handful of branchless loops over floats that the compiler can vectorize.
+* Not threadsafe, the Renderer guards it with kinematicsMtx.*/
+class KinematicSystem {
+public:
+	/* Returns the slot of "owner". Its index can change when other slots are removed, the owner's slot index is updated then. */
+	int add(ts::Drawable* owner, sf::Vector2f position, float rotation);
+
+	/* Removes the slot by moving the last one into it. Returns the owner that was moved into "slot" or nullptr. */
+	ts::Drawable* remove(int slot);
+
+	void setMotion(int slot, sf::Vector2f velocity, sf::Vector2f acceleration, float angularVelocity);
+
+	/* Advances all slots to "now" (seconds on the Renderer's frame clock). */
+	void integrate(double now);
+
+	ts::MotionState getState(int slot) {
+		return ts::MotionState{ sf::Vector2f(x[slot], y[slot]), sf::Vector2f(vx[slot], vy[slot]), rotation[slot] };
+	}
+
+	size_t getCount() {
+		return owners.size();
+	}
+
+private:
+	std::vector<ts::Drawable*> owners;
+	std::vector<float> x, y, vx, vy, ax, ay, rotation, angularVelocity;
+	double lastIntegration = 0.0;
+	//set when the system was empty, so that the first integration afterwards doesn't move anything
+	bool restartClock = true;
+};
\ No newline at end of file
@@ -0,0 +1,160 @@
+#include "LockProfiler.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <tuple>
+#include <iomanip>
+
+std::vector<std::unique_ptr<LockSite>> LockProfiler::sites;
+std::map<std::string, LockSite*> LockProfiler::sitesByKey;
+std::mutex LockProfiler::sitesMtx;
+
+LockSite* LockProfiler::getSite(const char* mutexName, const std::source_location& site) {
+	//the same file can have different name pointers in different translation units, so the shared map uses the strings
+	thread_local std::map<std::tuple<const char*, const char*, uint32_t, uint32_t>, LockSite*> cache;
+	auto cacheKey = std::make_tuple(mutexName, site.file_name(), (uint32_t)site.line(), (uint32_t)site.column());
+	auto cached = cache.find(cacheKey);
+	if (cached != cache.end()) {
+		return cached->second;
+	}
+
+	std::string key = std::string(mutexName) + "|" + site.file_name() + ":" + std::to_string(site.line()) + ":" + std::to_string(site.column());
+	sitesMtx.lock();
+	LockSite*& found = sitesByKey[key];
+	if (found == nullptr) {
+		sites.push_back(std::make_unique<LockSite>());
+		found = sites.back().get();
+		found->mutexName = mutexName;
+		found->file = site.file_name();
+		found->function = site.function_name();
+		found->line = site.line();
+	}
+	LockSite* result = found;
+	sitesMtx.unlock();
+	cache[cacheKey] = result;
+	return result;
+}
+
+void LockProfiler::clear() {
+	sitesMtx.lock();
+	for (size_t i = 0; i < sites.size(); i++) {
+		LockSite& site = *sites[i];
+		site.acquisitions.store(0);
+		site.contended.store(0);
+		site.waitNanoseconds.store(0);
+		site.maxWaitNanoseconds.store(0);
+		site.heldNanoseconds.store(0);
+		for (size_t b = 0; b < LockSite::histogramBuckets; b++) {
+			site.waitHistogram[b].store(0);
+		}
+		site.blockerMtx.lock();
+		site.blockers.clear();
+		site.blockerMtx.unlock();
+	}
+	sitesMtx.unlock();
+}
+
+static std::string describe(const LockSite& site) {
+	std::string file = site.file;
+	size_t slash = file.find_last_of("/\\");
+	if (slash != std::string::npos) {
+		file = file.substr(slash + 1);
+	}
+	return site.mutexName + " at " + file + ":" + std::to_string(site.line) + " (" + site.function + ")";
+}
+
+void LockProfiler::report(std::ostream& out, size_t count) {
+#ifndef TS_LOCK_PROFILER
+	out << "Lock profiler: not compiled in, define TS_LOCK_PROFILER\n";
+#else
+	sitesMtx.lock();
+	std::vector<LockSite*> sorted;
+	for (size_t i = 0; i < sites.size(); i++) {
+		sorted.push_back(sites[i].get());
+	}
+	std::sort(sorted.begin(), sorted.end(), [](LockSite* a, LockSite* b) { return a->waitNanoseconds.load() > b->waitNanoseconds.load(); });
+
+	out << "Lock profiler: " << std::min(count, sorted.size()) << " of " << sorted.size() << " lock sites by total wait time\n";
+	out << std::fixed << std::setprecision(3);
+	for (size_t i = 0; i < sorted.size() && i < count; i++) {
+		LockSite& site = *sorted[i];
+		uint64_t acquisitions = site.acquisitions.load(), contended = site.contended.load();
+		out << i + 1 << ". " << describe(site) << "\n";
+		out << "   acquisitions " << acquisitions << ", contended " << contended
+			<< " (" << (acquisitions > 0 ? 100.0 * contended / acquisitions : 0.0) << "%)"
+			<< ", wait " << site.waitNanoseconds.load() / 1e6 << " ms (max " << site.maxWaitNanoseconds.load() / 1e6 << " ms)"
+			<< ", held " << site.heldNanoseconds.load() / 1e6 << " ms\n";
+
+		out << "   wait histogram:";
+		for (size_t b = 0; b < LockSite::histogramBuckets; b++) {
+			if (b < LockSite::histogramBuckets - 1) {
+				out << " <" << LockSite::histogramBounds[b] << "us ";
+			}
+			else {
+				out << " more ";
+			}
+			out << site.waitHistogram[b].load();
+		}
+		out << "\n";
+
+		site.blockerMtx.lock();
+		std::vector<std::pair<std::pair<const LockSite*, uint32_t>, LockSite::Blocker>> blockers(site.blockers.begin(), site.blockers.end());
+		site.blockerMtx.unlock();
+		std::sort(blockers.begin(), blockers.end(), [](const auto& a, const auto& b) { return a.second.waitNanoseconds > b.second.waitNanoseconds; });
+		for (size_t b = 0; b < blockers.size() && b < 3; b++) {
+			const LockSite* holder = blockers[b].first.first;
+			out << "   blocked by " << (holder != nullptr ? describe(*holder) : std::string("unknown holder"))
+				<< " on " << Profiler::getThreadName(blockers[b].first.second)
+				<< ": " << blockers[b].second.count << " times, " << blockers[b].second.waitNanoseconds / 1e6 << " ms\n";
+		}
+	}
+	sitesMtx.unlock();
+#endif
+}
+
+#ifdef TS_LOCK_PROFILER
+void ProfiledMutex::lockProfiled(LockSite* site) {
+	if (mtx.try_lock() == true) {
+		acquired(site);
+		return;
+	}
+	//the holder can change until we get the mutex, the one we saw first is the one that made us wait
+	LockSite* holder = holderSite.load(std::memory_order_relaxed);
+	uint32_t thread = holderThread.load(std::memory_order_relaxed);
+	int64_t start = Profiler::now();
+	mtx.lock();
+	uint64_t wait = (uint64_t)(Profiler::now() - start);
+
+	site->contended.fetch_add(1, std::memory_order_relaxed);
+	site->waitNanoseconds.fetch_add(wait, std::memory_order_relaxed);
+	uint64_t max = site->maxWaitNanoseconds.load(std::memory_order_relaxed);
+	while (wait > max && site->maxWaitNanoseconds.compare_exchange_weak(max, wait, std::memory_order_relaxed) == false) {}
+	size_t bucket = 0;
+	while (bucket < LockSite::histogramBuckets - 1 && (int64_t)wait >= LockSite::histogramBounds[bucket] * 1000) {
+		bucket++;
+	}
+	site->waitHistogram[bucket].fetch_add(1, std::memory_order_relaxed);
+
+	site->blockerMtx.lock();
+	LockSite::Blocker& blocker = site->blockers[std::make_pair((const LockSite*)holder, thread)];
+	blocker.count++;
+	blocker.waitNanoseconds += wait;
+	site->blockerMtx.unlock();
+
+	acquired(site);
+}
+
+void ProfiledMutex::acquired(LockSite* site) {
+	site->acquisitions.fetch_add(1, std::memory_order_relaxed);
+	holderSite.store(site, std::memory_order_relaxed);
+	holderThread.store(Profiler::getThreadId(), std::memory_order_relaxed);
+	lockedAt = Profiler::now();
+}
+
+void ProfiledMutex::released() {
+	LockSite* site = holderSite.load(std::memory_order_relaxed);
+	if (site != nullptr) {
+		site->heldNanoseconds.fetch_add((uint64_t)(Profiler::now() - lockedAt), std::memory_order_relaxed);
+	}
+	holderSite.store(nullptr, std::memory_order_relaxed);
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,114 @@
+#pragma once
+#include <mutex>
+#include <atomic>
+#include <map>
+#include <vector>
+#include <memory>
+#include <string>
+#include <iostream>
+#include <cstdint>
+#include <source_location>
+
+/** Contention statistics of one lock site: a named mutex (every mutex with that name counts together, e.g. all Drawable::mtx)
+* locked from one place in the code.*/
+struct LockSite {
+	static constexpr size_t histogramBuckets = 9;
+	//Upper bounds of the wait time histogram buckets in microseconds, the last bucket has none
+	static constexpr int64_t histogramBounds[histogramBuckets - 1] = { 1, 4, 16, 64, 256, 1000, 4000, 16000 };
+
+	std::string mutexName;
+	std::string file;
+	std::string function;
+	uint32_t line = 0;
+
+	std::atomic<uint64_t> acquisitions = 0;
+	//acquisitions that had to wait because another thread held the mutex
+	std::atomic<uint64_t> contended = 0;
+	std::atomic<uint64_t> waitNanoseconds = 0;
+	std::atomic<uint64_t> maxWaitNanoseconds = 0;
+	//how long the mutex was held after being locked here
+	std::atomic<uint64_t> heldNanoseconds = 0;
+	std::atomic<uint64_t> waitHistogram[histogramBuckets] = {};
+
+	//Who held the mutex while this site waited for it: lock site and thread (see Profiler::getThreadId)
+	struct Blocker {
+		uint64_t count = 0;
+		uint64_t waitNanoseconds = 0;
+	};
+	std::mutex blockerMtx;
+	std::map<std::pair<const LockSite*, uint32_t>, Blocker> blockers;
+};
+
+/** Collects the LockSites of all ProfiledMutexes and reports the most contended ones.
+* Only records anything if TS_LOCK_PROFILER is defined (e.g. in the preprocessor definitions of the project).*/
+class LockProfiler {
+public:
+	/* The statistics of "mutexName" locked at "site". Cached per thread, so only the first call of a thread for a site locks. */
+	static LockSite* getSite(const char* mutexName, const std::source_location& site);
+
+	/* Writes the "count" sites with the longest total wait time, with their wait histograms and who blocked them. Can be called at any time. */
+	static void report(std::ostream& out = std::cout, size_t count = 10);
+
+	/* Resets all statistics. */
+	static void clear();
+
+private:
+	static std::vector<std::unique_ptr<LockSite>> sites;
+	static std::map<std::string, LockSite*> sitesByKey;
+	static std::mutex sitesMtx;
+};
+
+/** Drop-in for std::mutex that records per lock site how often it is locked, how long threads wait for it and who holds it meanwhile.
+* Without TS_LOCK_PROFILER it is a plain std::mutex, "name" and the call site are ignored then.
+* lock() takes the call site as default argument, wrappers (like ts::Drawable::lock) should forward their own to attribute waits to their callers.*/
+class ProfiledMutex {
+public:
+	ProfiledMutex(const char* name)
+#ifdef TS_LOCK_PROFILER
+		: name(name)
+#endif
+	{}
+	ProfiledMutex(const ProfiledMutex&) = delete;
+
+	void lock(const std::source_location& site = std::source_location::current()) {
+#ifdef TS_LOCK_PROFILER
+		lockProfiled(LockProfiler::getSite(name, site));
+#else
+		mtx.lock();
+#endif
+	}
+
+	bool try_lock(const std::source_location& site = std::source_location::current()) {
+#ifdef TS_LOCK_PROFILER
+		if (mtx.try_lock() == false) {
+			return false;
+		}
+		acquired(LockProfiler::getSite(name, site));
+		return true;
+#else
+		return mtx.try_lock();
+#endif
+	}
+
+	void unlock() {
+#ifdef TS_LOCK_PROFILER
+		released();
+#endif
+		mtx.unlock();
+	}
+
+private:
+	std::mutex mtx;
+#ifdef TS_LOCK_PROFILER
+	const char* name;
+	//Lock site and thread of the current holder, read by waiting threads
+	std::atomic<LockSite*> holderSite = nullptr;
+	std::atomic<uint32_t> holderThread = 0;
+	//only touched by the holder
+	int64_t lockedAt = 0;
+
+	void lockProfiled(LockSite* site);
+	void acquired(LockSite* site);
+	void released();
+#endif
+};
\ No newline at end of file
@@ -0,0 +1,86 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/** Bounded lock-free queue for many producer threads and exactly one consumer thread.
+* Every cell carries a sequence number that tells producers and the consumer whose turn it is, so neither side ever waits on a lock.
+* tryPush fails instead of blocking when the queue is full. Only ever call tryPop from one thread at a time!*/
+template<class T, size_t capacity>
+class MPSCQueue {
+	static_assert(capacity >= 2 && (capacity & (capacity - 1)) == 0, "MPSCQueue capacity has to be a power of two");
+
+	struct Cell {
+		std::atomic<size_t> sequence;
+		T data;
+	};
+	static constexpr size_t mask = capacity - 1;
+
+	Cell* cells;
+	//producers and consumer write to different cache lines
+	alignas(64) std::atomic<size_t> enqueuePos{ 0 };
+	alignas(64) size_t dequeuePos = 0;
+
+public:
+	MPSCQueue() : cells(new Cell[capacity]) {
+		for (size_t i = 0; i < capacity; i++) {
+			cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+	MPSCQueue(const MPSCQueue&) = delete;
+	MPSCQueue(MPSCQueue&&) = delete;
+
+	~MPSCQueue() {
+		delete[] cells;
+	}
+
+	//Returns false if the queue is full. Safe to call from any number of threads.
+	bool tryPush(const T& value) {
+		size_t pos = enqueuePos.load(std::memory_order_relaxed);
+		while (true) {
+			Cell& cell = cells[pos & mask];
+			size_t sequence = cell.sequence.load(std::memory_order_acquire);
+			intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+			if (diff == 0) {//cell is free for this position, try to claim it
+				if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					cell.data = value;
+					cell.sequence.store(pos + 1, std::memory_order_release);//publish to the consumer
+					return true;
+				}
+			}
+			else if (diff < 0) {//consumer has not freed this cell yet => full
+				return false;
+			}
+			else {//another producer claimed this position first
+				pos = enqueuePos.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	//Returns false if there is no published entry. Only call from the consumer thread.
+	bool tryPop(T& out) {
+		Cell& cell = cells[dequeuePos & mask];
+		size_t sequence = cell.sequence.load(std::memory_order_acquire);
+		if ((intptr_t)sequence - (intptr_t)(dequeuePos + 1) < 0) {
+			return false;
+		}
+		out = cell.data;
+		cell.sequence.store(dequeuePos + capacity, std::memory_order_release);//hand the cell back to the producers of the next lap
+		dequeuePos++;
+		return true;
+	}
+
+	//Position the next push will claim. Every push that happened before this call has a lower position. Safe to call from any thread.
+	size_t getEnqueuePosition() {
+		return enqueuePos.load(std::memory_order_acquire);
+	}
+
+	//Position of the next entry tryPop returns, everything below it was popped. Only call from the consumer thread.
+	size_t getDequeuePosition() {
+		return dequeuePos;
+	}
+
+	static constexpr size_t getCapacity() {
+		return capacity;
+	}
+};
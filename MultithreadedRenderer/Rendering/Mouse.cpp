@@ -8,6 +8,9 @@ int Mouse::clickCounter;
 int Mouse::finishedClickCounter;
 
 sf::Vector2i Mouse::getPosition(bool factorInBorders) {
+    if (Renderer::window == nullptr) {//headless
+        return lastMousePos;
+    }
     auto pos = sf::Mouse::getPosition(*Renderer::window);
     int xPixels = Renderer::getPixelCountX();
     int yPixels = Renderer::getPixelCountY();
@@ -0,0 +1,528 @@
+#include "PixelKernels.hpp"
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define PIXELKERNELS_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+//MSVC always allows intrinsics, it just must not run them on cpus that don't support them
+#define TARGET_SSE41
+#define TARGET_AVX2
+#else
+#define TARGET_SSE41 __attribute__((target("sse4.1")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+//Scalar---------------------------------------------------------------------------------------------------------------------------------------
+//The reference every other instruction set has to match exactly, so all of them do the same float operations in the same order.
+
+//x / 255 rounded, for x <= 65025
+static inline unsigned int div255(unsigned int x) {
+	x += 128;
+	return (x + (x >> 8)) >> 8;
+}
+
+static inline uint32_t loadTexel(const sf::Uint8* texels, int index) {
+	uint32_t texel;
+	std::memcpy(&texel, texels + (size_t)index * 4, 4);
+	return texel;
+}
+
+//Texel column/row of "c" in a texture with "size" texels in that direction
+static inline float wrapCoordinate(float c, float size, float invSize, bool repeated) {
+	if (repeated == true) {
+		c = c - std::floor(c * invSize) * size;
+		//c * invSize may be rounded into the neighbouring repetition
+		if (c < 0.0f) {
+			c += size;
+		}
+		if (c >= size) {
+			c -= size;
+		}
+	}
+	return std::min(std::max(c, 0.0f), size - 1.0f);
+}
+
+static inline void blendPixel(sf::Uint8* dst, unsigned int r, unsigned int g, unsigned int b, unsigned int a) {
+	unsigned int inverse = 255 - a;
+	dst[0] = (sf::Uint8)div255(r * a + dst[0] * inverse);
+	dst[1] = (sf::Uint8)div255(g * a + dst[1] * inverse);
+	dst[2] = (sf::Uint8)div255(b * a + dst[2] * inverse);
+	dst[3] = (sf::Uint8)div255(255 * a + dst[3] * inverse);
+}
+
+static void fillSpanScalar(sf::Uint8* dst, int count, sf::Color color) {
+	if (color.a == 255) {
+		for (int i = 0; i < count; i++, dst += 4) {
+			dst[0] = color.r;
+			dst[1] = color.g;
+			dst[2] = color.b;
+			dst[3] = 255;
+		}
+		return;
+	}
+	for (int i = 0; i < count; i++, dst += 4) {
+		blendPixel(dst, color.r, color.g, color.b, color.a);
+	}
+}
+
+//Pixels "first" to "last" - 1 of a span starting at "dst", so the SIMD kernels can finish their spans with it
+static void texturedPixelsScalar(sf::Uint8* dst, int first, int last, const PixelKernels::TextureSpan& span) {
+	const float width = (float)span.width, height = (float)span.height;
+	const float invWidth = 1.0f / width, invHeight = 1.0f / height;
+	const sf::Color tint = span.tint;
+	unsigned int texel[4];
+	for (int i = first; i < last; i++) {
+		float u = span.u + (float)i * span.dudx;
+		float v = span.v + (float)i * span.dvdx;
+		if (span.smooth == false) {
+			int tx = (int)wrapCoordinate(std::floor(u), width, invWidth, span.repeated);
+			int ty = (int)wrapCoordinate(std::floor(v), height, invHeight, span.repeated);
+			const sf::Uint8* t = &span.texels[((size_t)ty * span.width + tx) * 4];
+			for (int c = 0; c < 4; c++) {
+				texel[c] = t[c];
+			}
+		}
+		else {
+			//texel centers are at +0.5
+			float x = u - 0.5f, y = v - 0.5f;
+			float x0 = std::floor(x), y0 = std::floor(y);
+			unsigned int fx = (unsigned int)(int)((x - x0) * 256.0f), fy = (unsigned int)(int)((y - y0) * 256.0f);
+			int tx0 = (int)wrapCoordinate(x0, width, invWidth, span.repeated);
+			int tx1 = (int)wrapCoordinate(x0 + 1.0f, width, invWidth, span.repeated);
+			int ty0 = (int)wrapCoordinate(y0, height, invHeight, span.repeated);
+			int ty1 = (int)wrapCoordinate(y0 + 1.0f, height, invHeight, span.repeated);
+			const sf::Uint8* t00 = &span.texels[((size_t)ty0 * span.width + tx0) * 4];
+			const sf::Uint8* t10 = &span.texels[((size_t)ty0 * span.width + tx1) * 4];
+			const sf::Uint8* t01 = &span.texels[((size_t)ty1 * span.width + tx0) * 4];
+			const sf::Uint8* t11 = &span.texels[((size_t)ty1 * span.width + tx1) * 4];
+			for (int c = 0; c < 4; c++) {
+				unsigned int top = (t00[c] * (256 - fx) + t10[c] * fx) >> 8;
+				unsigned int bottom = (t01[c] * (256 - fx) + t11[c] * fx) >> 8;
+				texel[c] = (top * (256 - fy) + bottom * fy) >> 8;
+			}
+		}
+		blendPixel(&dst[i * 4], div255(texel[0] * tint.r), div255(texel[1] * tint.g), div255(texel[2] * tint.b), div255(texel[3] * tint.a));
+	}
+}
+
+static void texturedSpanScalar(sf::Uint8* dst, int count, const PixelKernels::TextureSpan& span) {
+	texturedPixelsScalar(dst, 0, count, span);
+}
+
+#ifdef PIXELKERNELS_X86
+//SSE4.1---------------------------------------------------------------------------------------------------------------------------------------
+//4 pixels at a time, channels are widened to 16 bit (2 pixels per register) for the math.
+
+TARGET_SSE41 static inline __m128i div255Sse(__m128i x) {
+	x = _mm_add_epi16(x, _mm_set1_epi16(128));
+	return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+//Pixels 0, 1 and 2, 3 of 4 packed pixels with 16 bit channels
+TARGET_SSE41 static inline __m128i lowSse(__m128i pixels) {
+	return _mm_cvtepu8_epi16(pixels);
+}
+
+TARGET_SSE41 static inline __m128i highSse(__m128i pixels) {
+	return _mm_unpackhi_epi8(pixels, _mm_setzero_si128());
+}
+
+//Every channel of the 2 pixels is the 32 bit value of its pixel in the lower half of "values"
+TARGET_SSE41 static inline __m128i broadcastSse(__m128i values) {
+	__m128i wide = _mm_cvtepu32_epi64(values);
+	wide = _mm_or_si128(wide, _mm_slli_epi64(wide, 16));
+	return _mm_or_si128(wide, _mm_slli_epi64(wide, 32));
+}
+
+TARGET_SSE41 static inline __m128i lerpSse(__m128i a, __m128i b, __m128i weight) {
+	__m128i sum = _mm_add_epi16(_mm_mullo_epi16(a, _mm_sub_epi16(_mm_set1_epi16(256), weight)), _mm_mullo_epi16(b, weight));
+	return _mm_srli_epi16(sum, 8);
+}
+
+//Tints "texels" and blends them over "dst", both 2 pixels with 16 bit channels
+TARGET_SSE41 static inline __m128i tintBlendSse(__m128i texels, __m128i dst, __m128i tint) {
+	__m128i src = div255Sse(_mm_mullo_epi16(texels, tint));
+	__m128i alpha = _mm_shuffle_epi8(src, _mm_setr_epi8(6, 7, 6, 7, 6, 7, 6, 7, 14, 15, 14, 15, 14, 15, 14, 15));
+	__m128i inverse = _mm_sub_epi16(_mm_set1_epi16(255), alpha);
+	//the alpha channel blends 255 * alpha, see blendPixel
+	src = _mm_blend_epi16(src, _mm_set1_epi16(255), 0x88);
+	return div255Sse(_mm_add_epi16(_mm_mullo_epi16(src, alpha), _mm_mullo_epi16(dst, inverse)));
+}
+
+TARGET_SSE41 static inline __m128 wrapSse(__m128 c, __m128 size, __m128 invSize, bool repeated) {
+	if (repeated == true) {
+		c = _mm_sub_ps(c, _mm_mul_ps(_mm_floor_ps(_mm_mul_ps(c, invSize)), size));
+		c = _mm_add_ps(c, _mm_and_ps(_mm_cmplt_ps(c, _mm_setzero_ps()), size));
+		c = _mm_sub_ps(c, _mm_and_ps(_mm_cmpge_ps(c, size), size));
+	}
+	return _mm_min_ps(_mm_max_ps(c, _mm_setzero_ps()), _mm_sub_ps(size, _mm_set1_ps(1.0f)));
+}
+
+TARGET_SSE41 static inline __m128i fetchSse(const sf::Uint8* texels, __m128i indices) {
+	alignas(16) int32_t index[4];
+	_mm_store_si128((__m128i*)index, indices);
+	return _mm_setr_epi32((int)loadTexel(texels, index[0]), (int)loadTexel(texels, index[1]),
+		(int)loadTexel(texels, index[2]), (int)loadTexel(texels, index[3]));
+}
+
+TARGET_SSE41 static void fillSpanSse41(sf::Uint8* dst, int count, sf::Color color) {
+	int i = 0;
+	if (color.a == 255) {
+		uint32_t packed;
+		std::memcpy(&packed, &color, 4);
+		__m128i pixels = _mm_set1_epi32((int)packed);
+		for (; i + 4 <= count; i += 4) {
+			_mm_storeu_si128((__m128i*)&dst[i * 4], pixels);
+		}
+	}
+	else {
+		short a = color.a;
+		__m128i src = _mm_setr_epi16(color.r * a, color.g * a, color.b * a, 255 * a, color.r * a, color.g * a, color.b * a, 255 * a);
+		__m128i inverse = _mm_set1_epi16(255 - a);
+		for (; i + 4 <= count; i += 4) {
+			__m128i pixels = _mm_loadu_si128((const __m128i*)&dst[i * 4]);
+			__m128i low = div255Sse(_mm_add_epi16(_mm_mullo_epi16(lowSse(pixels), inverse), src));
+			__m128i high = div255Sse(_mm_add_epi16(_mm_mullo_epi16(highSse(pixels), inverse), src));
+			_mm_storeu_si128((__m128i*)&dst[i * 4], _mm_packus_epi16(low, high));
+		}
+	}
+	fillSpanScalar(&dst[i * 4], count - i, color);
+}
+
+TARGET_SSE41 static void texturedSpanSse41(sf::Uint8* dst, int count, const PixelKernels::TextureSpan& span) {
+	const __m128 width = _mm_set1_ps((float)span.width), height = _mm_set1_ps((float)span.height);
+	const __m128 invWidth = _mm_set1_ps(1.0f / (float)span.width), invHeight = _mm_set1_ps(1.0f / (float)span.height);
+	const __m128i textureWidth = _mm_set1_epi32(span.width);
+	const __m128i tint = _mm_setr_epi16(span.tint.r, span.tint.g, span.tint.b, span.tint.a, span.tint.r, span.tint.g, span.tint.b, span.tint.a);
+	const __m128 lanes = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+	const __m128 half = _mm_set1_ps(0.5f), one = _mm_set1_ps(1.0f), fractionScale = _mm_set1_ps(256.0f);
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128 index = _mm_add_ps(_mm_set1_ps((float)i), lanes);
+		__m128 u = _mm_add_ps(_mm_set1_ps(span.u), _mm_mul_ps(index, _mm_set1_ps(span.dudx)));
+		__m128 v = _mm_add_ps(_mm_set1_ps(span.v), _mm_mul_ps(index, _mm_set1_ps(span.dvdx)));
+		__m128i low, high;
+		if (span.smooth == false) {
+			__m128i tx = _mm_cvttps_epi32(wrapSse(_mm_floor_ps(u), width, invWidth, span.repeated));
+			__m128i ty = _mm_cvttps_epi32(wrapSse(_mm_floor_ps(v), height, invHeight, span.repeated));
+			__m128i texels = fetchSse(span.texels, _mm_add_epi32(_mm_mullo_epi32(ty, textureWidth), tx));
+			low = lowSse(texels);
+			high = highSse(texels);
+		}
+		else {
+			__m128 x = _mm_sub_ps(u, half), y = _mm_sub_ps(v, half);
+			__m128 x0 = _mm_floor_ps(x), y0 = _mm_floor_ps(y);
+			__m128i fx = _mm_cvttps_epi32(_mm_mul_ps(_mm_sub_ps(x, x0), fractionScale));
+			__m128i fy = _mm_cvttps_epi32(_mm_mul_ps(_mm_sub_ps(y, y0), fractionScale));
+			__m128i tx0 = _mm_cvttps_epi32(wrapSse(x0, width, invWidth, span.repeated));
+			__m128i tx1 = _mm_cvttps_epi32(wrapSse(_mm_add_ps(x0, one), width, invWidth, span.repeated));
+			__m128i row0 = _mm_mullo_epi32(_mm_cvttps_epi32(wrapSse(y0, height, invHeight, span.repeated)), textureWidth);
+			__m128i row1 = _mm_mullo_epi32(_mm_cvttps_epi32(wrapSse(_mm_add_ps(y0, one), height, invHeight, span.repeated)), textureWidth);
+			__m128i t00 = fetchSse(span.texels, _mm_add_epi32(row0, tx0));
+			__m128i t10 = fetchSse(span.texels, _mm_add_epi32(row0, tx1));
+			__m128i t01 = fetchSse(span.texels, _mm_add_epi32(row1, tx0));
+			__m128i t11 = fetchSse(span.texels, _mm_add_epi32(row1, tx1));
+			__m128i wxLow = broadcastSse(fx), wxHigh = broadcastSse(_mm_srli_si128(fx, 8));
+			__m128i wyLow = broadcastSse(fy), wyHigh = broadcastSse(_mm_srli_si128(fy, 8));
+			low = lerpSse(lerpSse(lowSse(t00), lowSse(t10), wxLow), lerpSse(lowSse(t01), lowSse(t11), wxLow), wyLow);
+			high = lerpSse(lerpSse(highSse(t00), highSse(t10), wxHigh), lerpSse(highSse(t01), highSse(t11), wxHigh), wyHigh);
+		}
+		__m128i pixels = _mm_loadu_si128((const __m128i*)&dst[i * 4]);
+		low = tintBlendSse(low, lowSse(pixels), tint);
+		high = tintBlendSse(high, highSse(pixels), tint);
+		_mm_storeu_si128((__m128i*)&dst[i * 4], _mm_packus_epi16(low, high));
+	}
+	texturedPixelsScalar(dst, i, count, span);
+}
+
+//AVX2-----------------------------------------------------------------------------------------------------------------------------------------
+//Same as SSE4.1 with 8 pixels at a time and gathered texels. 16 bit registers hold 4 pixels, 2 in each 128 bit lane.
+
+TARGET_AVX2 static inline __m256i div255Avx(__m256i x) {
+	x = _mm256_add_epi16(x, _mm256_set1_epi16(128));
+	return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+}
+
+//Pixels 0 to 3 and 4 to 7 of 8 packed pixels with 16 bit channels
+TARGET_AVX2 static inline __m256i lowAvx(__m256i pixels) {
+	return _mm256_cvtepu8_epi16(_mm256_castsi256_si128(pixels));
+}
+
+TARGET_AVX2 static inline __m256i highAvx(__m256i pixels) {
+	return _mm256_cvtepu8_epi16(_mm256_extracti128_si256(pixels, 1));
+}
+
+//Inverse of lowAvx/highAvx, _mm256_packus_epi16 works per lane so the 64 bit blocks are in the order 0, 2, 1, 3 afterwards
+TARGET_AVX2 static inline __m256i packAvx(__m256i low, __m256i high) {
+	return _mm256_permute4x64_epi64(_mm256_packus_epi16(low, high), 0xD8);
+}
+
+//Every channel of the 4 pixels is the 32 bit value of its pixel in "values"
+TARGET_AVX2 static inline __m256i broadcastAvx(__m128i values) {
+	__m256i wide = _mm256_cvtepu32_epi64(values);
+	wide = _mm256_or_si256(wide, _mm256_slli_epi64(wide, 16));
+	return _mm256_or_si256(wide, _mm256_slli_epi64(wide, 32));
+}
+
+TARGET_AVX2 static inline __m256i lerpAvx(__m256i a, __m256i b, __m256i weight) {
+	__m256i sum = _mm256_add_epi16(_mm256_mullo_epi16(a, _mm256_sub_epi16(_mm256_set1_epi16(256), weight)), _mm256_mullo_epi16(b, weight));
+	return _mm256_srli_epi16(sum, 8);
+}
+
+TARGET_AVX2 static inline __m256i tintBlendAvx(__m256i texels, __m256i dst, __m256i tint) {
+	__m256i src = div255Avx(_mm256_mullo_epi16(texels, tint));
+	__m256i alpha = _mm256_shuffle_epi8(src, _mm256_setr_epi8(6, 7, 6, 7, 6, 7, 6, 7, 14, 15, 14, 15, 14, 15, 14, 15,
+		6, 7, 6, 7, 6, 7, 6, 7, 14, 15, 14, 15, 14, 15, 14, 15));
+	__m256i inverse = _mm256_sub_epi16(_mm256_set1_epi16(255), alpha);
+	src = _mm256_blend_epi16(src, _mm256_set1_epi16(255), 0x88);
+	return div255Avx(_mm256_add_epi16(_mm256_mullo_epi16(src, alpha), _mm256_mullo_epi16(dst, inverse)));
+}
+
+TARGET_AVX2 static inline __m256 wrapAvx(__m256 c, __m256 size, __m256 invSize, bool repeated) {
+	if (repeated == true) {
+		c = _mm256_sub_ps(c, _mm256_mul_ps(_mm256_floor_ps(_mm256_mul_ps(c, invSize)), size));
+		c = _mm256_add_ps(c, _mm256_and_ps(_mm256_cmp_ps(c, _mm256_setzero_ps(), _CMP_LT_OQ), size));
+		c = _mm256_sub_ps(c, _mm256_and_ps(_mm256_cmp_ps(c, size, _CMP_GE_OQ), size));
+	}
+	return _mm256_min_ps(_mm256_max_ps(c, _mm256_setzero_ps()), _mm256_sub_ps(size, _mm256_set1_ps(1.0f)));
+}
+
+TARGET_AVX2 static inline __m256i fetchAvx(const sf::Uint8* texels, __m256i indices) {
+	return _mm256_i32gather_epi32((const int*)texels, indices, 4);
+}
+
+TARGET_AVX2 static void fillSpanAvx2(sf::Uint8* dst, int count, sf::Color color) {
+	int i = 0;
+	if (color.a == 255) {
+		uint32_t packed;
+		std::memcpy(&packed, &color, 4);
+		__m256i pixels = _mm256_set1_epi32((int)packed);
+		for (; i + 8 <= count; i += 8) {
+			_mm256_storeu_si256((__m256i*)&dst[i * 4], pixels);
+		}
+	}
+	else {
+		short a = color.a;
+		__m256i src = _mm256_setr_epi16(color.r * a, color.g * a, color.b * a, 255 * a, color.r * a, color.g * a, color.b * a, 255 * a,
+			color.r * a, color.g * a, color.b * a, 255 * a, color.r * a, color.g * a, color.b * a, 255 * a);
+		__m256i inverse = _mm256_set1_epi16(255 - a);
+		for (; i + 8 <= count; i += 8) {
+			__m256i pixels = _mm256_loadu_si256((const __m256i*)&dst[i * 4]);
+			__m256i low = div255Avx(_mm256_add_epi16(_mm256_mullo_epi16(lowAvx(pixels), inverse), src));
+			__m256i high = div255Avx(_mm256_add_epi16(_mm256_mullo_epi16(highAvx(pixels), inverse), src));
+			_mm256_storeu_si256((__m256i*)&dst[i * 4], packAvx(low, high));
+		}
+	}
+	fillSpanScalar(&dst[i * 4], count - i, color);
+}
+
+TARGET_AVX2 static void texturedSpanAvx2(sf::Uint8* dst, int count, const PixelKernels::TextureSpan& span) {
+	const __m256 width = _mm256_set1_ps((float)span.width), height = _mm256_set1_ps((float)span.height);
+	const __m256 invWidth = _mm256_set1_ps(1.0f / (float)span.width), invHeight = _mm256_set1_ps(1.0f / (float)span.height);
+	const __m256i textureWidth = _mm256_set1_epi32(span.width);
+	const __m256i tint = _mm256_setr_epi16(span.tint.r, span.tint.g, span.tint.b, span.tint.a, span.tint.r, span.tint.g, span.tint.b, span.tint.a,
+		span.tint.r, span.tint.g, span.tint.b, span.tint.a, span.tint.r, span.tint.g, span.tint.b, span.tint.a);
+	const __m256 lanes = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+	const __m256 half = _mm256_set1_ps(0.5f), one = _mm256_set1_ps(1.0f), fractionScale = _mm256_set1_ps(256.0f);
+
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		__m256 index = _mm256_add_ps(_mm256_set1_ps((float)i), lanes);
+		__m256 u = _mm256_add_ps(_mm256_set1_ps(span.u), _mm256_mul_ps(index, _mm256_set1_ps(span.dudx)));
+		__m256 v = _mm256_add_ps(_mm256_set1_ps(span.v), _mm256_mul_ps(index, _mm256_set1_ps(span.dvdx)));
+		__m256i low, high;
+		if (span.smooth == false) {
+			__m256i tx = _mm256_cvttps_epi32(wrapAvx(_mm256_floor_ps(u), width, invWidth, span.repeated));
+			__m256i ty = _mm256_cvttps_epi32(wrapAvx(_mm256_floor_ps(v), height, invHeight, span.repeated));
+			__m256i texels = fetchAvx(span.texels, _mm256_add_epi32(_mm256_mullo_epi32(ty, textureWidth), tx));
+			low = lowAvx(texels);
+			high = highAvx(texels);
+		}
+		else {
+			__m256 x = _mm256_sub_ps(u, half), y = _mm256_sub_ps(v, half);
+			__m256 x0 = _mm256_floor_ps(x), y0 = _mm256_floor_ps(y);
+			__m256i fx = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_sub_ps(x, x0), fractionScale));
+			__m256i fy = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_sub_ps(y, y0), fractionScale));
+			__m256i tx0 = _mm256_cvttps_epi32(wrapAvx(x0, width, invWidth, span.repeated));
+			__m256i tx1 = _mm256_cvttps_epi32(wrapAvx(_mm256_add_ps(x0, one), width, invWidth, span.repeated));
+			__m256i row0 = _mm256_mullo_epi32(_mm256_cvttps_epi32(wrapAvx(y0, height, invHeight, span.repeated)), textureWidth);
+			__m256i row1 = _mm256_mullo_epi32(_mm256_cvttps_epi32(wrapAvx(_mm256_add_ps(y0, one), height, invHeight, span.repeated)), textureWidth);
+			__m256i t00 = fetchAvx(span.texels, _mm256_add_epi32(row0, tx0));
+			__m256i t10 = fetchAvx(span.texels, _mm256_add_epi32(row0, tx1));
+			__m256i t01 = fetchAvx(span.texels, _mm256_add_epi32(row1, tx0));
+			__m256i t11 = fetchAvx(span.texels, _mm256_add_epi32(row1, tx1));
+			__m256i wxLow = broadcastAvx(_mm256_castsi256_si128(fx)), wxHigh = broadcastAvx(_mm256_extracti128_si256(fx, 1));
+			__m256i wyLow = broadcastAvx(_mm256_castsi256_si128(fy)), wyHigh = broadcastAvx(_mm256_extracti128_si256(fy, 1));
+			low = lerpAvx(lerpAvx(lowAvx(t00), lowAvx(t10), wxLow), lerpAvx(lowAvx(t01), lowAvx(t11), wxLow), wyLow);
+			high = lerpAvx(lerpAvx(highAvx(t00), highAvx(t10), wxHigh), lerpAvx(highAvx(t01), highAvx(t11), wxHigh), wyHigh);
+		}
+		__m256i pixels = _mm256_loadu_si256((const __m256i*)&dst[i * 4]);
+		low = tintBlendAvx(low, lowAvx(pixels), tint);
+		high = tintBlendAvx(high, highAvx(pixels), tint);
+		_mm256_storeu_si256((__m256i*)&dst[i * 4], packAvx(low, high));
+	}
+	texturedPixelsScalar(dst, i, count, span);
+}
+#endif
+
+//Dispatch-------------------------------------------------------------------------------------------------------------------------------------
+
+bool PixelKernels::isSupported(InstructionSet set) {
+	if (set == InstructionSet::Scalar) {
+		return true;
+	}
+#if defined(PIXELKERNELS_X86) && defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	int maxLeaf = info[0];
+	__cpuid(info, 1);
+	bool sse41 = (info[2] & (1 << 19)) != 0;
+	if (set == InstructionSet::SSE41) {
+		return sse41;
+	}
+	//AVX registers also need to be saved by the OS
+	bool osAvx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 6) == 6;
+	if (maxLeaf < 7 || osAvx == false) {
+		return false;
+	}
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#elif defined(PIXELKERNELS_X86)
+	if (set == InstructionSet::SSE41) {
+		return __builtin_cpu_supports("sse4.1");
+	}
+	return __builtin_cpu_supports("avx2");
+#else
+	return false;
+#endif
+}
+
+static PixelKernels::InstructionSet bestInstructionSet() {
+	if (PixelKernels::isSupported(PixelKernels::InstructionSet::AVX2) == true) {
+		return PixelKernels::InstructionSet::AVX2;
+	}
+	if (PixelKernels::isSupported(PixelKernels::InstructionSet::SSE41) == true) {
+		return PixelKernels::InstructionSet::SSE41;
+	}
+	return PixelKernels::InstructionSet::Scalar;
+}
+
+PixelKernels::InstructionSet PixelKernels::instructionSet = PixelKernels::InstructionSet::Scalar;
+PixelKernels::FillSpanKernel PixelKernels::fillSpanKernel = fillSpanScalar;
+PixelKernels::TexturedSpanKernel PixelKernels::texturedSpanKernel = texturedSpanScalar;
+//picks the best kernels before main() runs, so that the rasterizer threads never race on the selection
+static bool kernelsSelected = PixelKernels::setInstructionSet(bestInstructionSet());
+
+bool PixelKernels::setInstructionSet(InstructionSet set) {
+	if (isSupported(set) == false) {
+		return false;
+	}
+	instructionSet = set;
+	switch (set) {
+#ifdef PIXELKERNELS_X86
+	case InstructionSet::AVX2:
+		fillSpanKernel = fillSpanAvx2;
+		texturedSpanKernel = texturedSpanAvx2;
+		break;
+	case InstructionSet::SSE41:
+		fillSpanKernel = fillSpanSse41;
+		texturedSpanKernel = texturedSpanSse41;
+		break;
+#endif
+	default:
+		fillSpanKernel = fillSpanScalar;
+		texturedSpanKernel = texturedSpanScalar;
+		break;
+	}
+	return true;
+}
+
+PixelKernels::InstructionSet PixelKernels::getInstructionSet() {
+	return instructionSet;
+}
+
+const char* PixelKernels::getName(InstructionSet set) {
+	switch (set) {
+	case InstructionSet::AVX2:
+		return "AVX2";
+	case InstructionSet::SSE41:
+		return "SSE4.1";
+	default:
+		return "Scalar";
+	}
+}
+
+void PixelKernels::fillSpan(sf::Uint8* dst, int count, sf::Color color) {
+	fillSpanKernel(dst, count, color);
+}
+
+void PixelKernels::texturedSpan(sf::Uint8* dst, int count, const TextureSpan& span) {
+	texturedSpanKernel(dst, count, span);
+}
+
+//Benchmark------------------------------------------------------------------------------------------------------------------------------------
+
+std::vector<PixelKernels::BenchmarkResult> PixelKernels::benchmark(size_t pixelCount) {
+	constexpr int width = 1920, height = 1080, spanLength = 64;
+	std::vector<sf::Uint8> framebuffer((size_t)width * height * 4, 0);
+	//repeated 64x64 checkerboard with varying alpha, like a tiled background
+	constexpr int textureSize = 64;
+	std::vector<sf::Uint8> texels((size_t)textureSize * textureSize * 4);
+	for (int y = 0; y < textureSize; y++) {
+		for (int x = 0; x < textureSize; x++) {
+			sf::Uint8* texel = &texels[((size_t)y * textureSize + x) * 4];
+			bool dark = ((x / 8) + (y / 8)) % 2 == 0;
+			texel[0] = dark ? 40 : 220;
+			texel[1] = (sf::Uint8)(x * 4);
+			texel[2] = (sf::Uint8)(y * 4);
+			texel[3] = (sf::Uint8)(128 + x + y);
+		}
+	}
+	TextureSpan nearest{ texels.data(), textureSize, textureSize, 0.0f, 0.0f, 0.7f, 0.2f, true, false, sf::Color(255, 255, 255, 230) };
+	TextureSpan bilinear = nearest;
+	bilinear.smooth = true;
+
+	struct Kernel {
+		const char* name;
+		std::function<void(sf::Uint8*, int, int)> run;
+	};
+	Kernel kernels[] = {
+		{ "fill opaque", [](sf::Uint8* dst, int count, int row) { fillSpan(dst, count, sf::Color(30, 60, 90)); } },
+		{ "fill blended", [](sf::Uint8* dst, int count, int row) { fillSpan(dst, count, sf::Color(200, 100, 50, 128)); } },
+		{ "textured nearest", [&](sf::Uint8* dst, int count, int row) { TextureSpan span = nearest; span.v = (float)row; texturedSpan(dst, count, span); } },
+		{ "textured bilinear", [&](sf::Uint8* dst, int count, int row) { TextureSpan span = bilinear; span.v = (float)row; texturedSpan(dst, count, span); } }
+	};
+
+	InstructionSet previous = instructionSet;
+	std::vector<BenchmarkResult> results;
+	for (InstructionSet set : { InstructionSet::Scalar, InstructionSet::SSE41, InstructionSet::AVX2 }) {
+		if (setInstructionSet(set) == false) {
+			continue;
+		}
+		for (const Kernel& kernel : kernels) {
+			size_t drawn = 0;
+			auto start = std::chrono::steady_clock::now();
+			while (drawn < pixelCount) {
+				for (int row = 0; row < height && drawn < pixelCount; row++) {
+					for (int x = 0; x < width; x += spanLength) {
+						kernel.run(&framebuffer[((size_t)row * width + x) * 4], spanLength, row);
+					}
+					drawn += width;
+				}
+			}
+			double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			results.push_back(BenchmarkResult{ kernel.name, set, seconds > 0 ? drawn / seconds / 1000000.0 : 0.0 });
+		}
+	}
+	setInstructionSet(previous);
+	return results;
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+#pragma once
+#include <vector>
+#include "SFML/Graphics.hpp"
+
+/** Inner loops of the SoftwareRasterizer, working on spans of RGBA pixels.
+* Every kernel has a scalar, an SSE4.1 and an AVX2 version. The best one the cpu supports is picked when the program starts,
+* all of them produce exactly the same pixels, so the instruction set never changes how a frame looks.
+* Blending is src-over like sf::BlendAlpha, divisions by 255 are rounded.*/
+class PixelKernels {
+public:
+	enum class InstructionSet { Scalar, SSE41, AVX2 };
+
+	//Texture coordinates of the first pixel center of a span and their change per pixel to the right
+	struct TextureSpan {
+		const sf::Uint8* texels;
+		int width, height;
+		float u, v, dudx, dvdx;
+		bool repeated;
+		//bilinear filtering like sf::Texture::setSmooth, nearest texel otherwise
+		bool smooth;
+		sf::Color tint;
+	};
+
+	/* Blends "color" over "count" pixels. Opaque colors are written without blending. */
+	static void fillSpan(sf::Uint8* dst, int count, sf::Color color);
+	/* Blends the texels of "span" multiplied with its tint over "count" pixels. */
+	static void texturedSpan(sf::Uint8* dst, int count, const TextureSpan& span);
+
+	static InstructionSet getInstructionSet();
+	static bool isSupported(InstructionSet set);
+	/* Uses the kernels of "set" from now on, e.g. to compare them. Returns false if the cpu doesn't support it. Not thread safe while kernels run. */
+	static bool setInstructionSet(InstructionSet set);
+	static const char* getName(InstructionSet set);
+
+	struct BenchmarkResult {
+		const char* kernel;
+		InstructionSet set;
+		double megapixelsPerSecond;
+	};
+	/** Runs every kernel with every supported instruction set over a 1920x1080 framebuffer until "pixelCount" pixels are drawn.
+	* Spans are 64 pixels long like the tile rows of the SoftwareRasterizer.
+	* The instruction set that was used before is restored afterwards.*/
+	static std::vector<BenchmarkResult> benchmark(size_t pixelCount = 200000000);
+
+private:
+	using FillSpanKernel = void(*)(sf::Uint8*, int, sf::Color);
+	using TexturedSpanKernel = void(*)(sf::Uint8*, int, const TextureSpan&);
+
+	static InstructionSet instructionSet;
+	static FillSpanKernel fillSpanKernel;
+	static TexturedSpanKernel texturedSpanKernel;
+};
\ No newline at end of file
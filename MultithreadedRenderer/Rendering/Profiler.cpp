@@ -0,0 +1,93 @@
+#include "Profiler.hpp"
+#include <fstream>
+#include <algorithm>
+
+const std::chrono::steady_clock::time_point Profiler::epoch = std::chrono::steady_clock::now();
+std::vector<std::unique_ptr<Profiler::ThreadEvents>> Profiler::threads;
+std::mutex Profiler::threadsMtx;
+
+Profiler::ThreadEvents* Profiler::getThreadEvents() {
+	thread_local ThreadEvents* local = nullptr;
+	if (local == nullptr) {
+		threadsMtx.lock();
+		threads.push_back(std::make_unique<ThreadEvents>());
+		local = threads.back().get();
+		local->id = (uint32_t)threads.size();
+		local->name = "Thread " + std::to_string(local->id);
+		threadsMtx.unlock();
+	}
+	return local;
+}
+
+void Profiler::record(const char* name, int64_t start, int64_t end) {
+	ThreadEvents* thread = getThreadEvents();
+	if (thread->events.empty() == true) {
+		thread->events.resize(eventsPerThread);
+	}
+	uint64_t written = thread->written.load(std::memory_order_relaxed);
+	thread->events[written % eventsPerThread] = Event{ name, start, end - start };
+	thread->written.store(written + 1, std::memory_order_release);
+}
+
+void Profiler::setThreadName(const std::string& name) {
+	ThreadEvents* thread = getThreadEvents();
+	threadsMtx.lock();//read by writeChromeTrace
+	thread->name = name;
+	threadsMtx.unlock();
+}
+
+std::string Profiler::getThreadName(uint32_t id) {
+	std::string name;
+	threadsMtx.lock();
+	if (id >= 1 && id <= threads.size()) {
+		name = threads[id - 1]->name;
+	}
+	threadsMtx.unlock();
+	return name;
+}
+
+void Profiler::clear() {
+	threadsMtx.lock();
+	for (size_t i = 0; i < threads.size(); i++) {
+		threads[i]->clearedAt.store(threads[i]->written.load(std::memory_order_acquire));
+	}
+	threadsMtx.unlock();
+}
+
+bool Profiler::writeChromeTrace(const std::string& path) {
+	std::ofstream file(path);
+	if (file.is_open() == false) {
+		return false;
+	}
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	bool first = true;
+	threadsMtx.lock();
+	for (size_t t = 0; t < threads.size(); t++) {
+		ThreadEvents& thread = *threads[t];
+		if (first == false) {
+			file << ",\n";
+		}
+		first = false;
+		file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread.id << ",\"args\":{\"name\":\"" << thread.name << "\"}}";
+
+		uint64_t written = thread.written.load(std::memory_order_acquire);
+		if (written == 0) {//only named, events may not be allocated
+			continue;
+		}
+		uint64_t oldest = std::max(thread.clearedAt.load(), written > eventsPerThread ? written - eventsPerThread : 0);
+		//the thread keeps recording, leave a margin so that the oldest events aren't overwritten while they are read
+		if (written + eventsPerThread / 16 > eventsPerThread) {
+			oldest = std::max(oldest, written + eventsPerThread / 16 - eventsPerThread);
+		}
+		for (uint64_t i = oldest; i < written; i++) {
+			const Event& event = thread.events[i % eventsPerThread];
+			//microseconds with nanosecond precision
+			file << ",\n{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread.id
+				<< ",\"ts\":" << event.start / 1000 << "." << (event.start % 1000) / 100 << (event.start % 100) / 10 << event.start % 10
+				<< ",\"dur\":" << event.duration / 1000 << "." << (event.duration % 1000) / 100 << (event.duration % 100) / 10 << event.duration % 10 << "}";
+		}
+	}
+	threadsMtx.unlock();
+	file << "\n]}\n";
+	return file.good();
+}
\ No newline at end of file
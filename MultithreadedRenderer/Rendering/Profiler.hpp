@@ -0,0 +1,102 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+
+/** Scoped timers for the phases of a frame, exported as Chrome trace JSON (chrome://tracing or ui.perfetto.dev).
+* Only compiled in if TS_PROFILER is defined (e.g. in the preprocessor definitions of the project), otherwise the PROFILE_ macros are empty.
+* Every thread records into its own ring buffer of the last "eventsPerThread" events, so recording never locks.
+*
+* PROFILE_SCOPE("name") times the rest of the enclosing block, PROFILE_PHASE(variable, "name") ... PROFILE_END(variable) times a part of a block.
+* Names must be string literals (or live as long as the program).*/
+class Profiler {
+public:
+	static constexpr size_t eventsPerThread = 1 << 16;
+
+	//Ends when it is destroyed or end() is called
+	class Scope {
+	public:
+		Scope(const char* name) : name(name), start(now()) {}
+		~Scope() {
+			end();
+		}
+		void end() {
+			if (name != nullptr) {
+				record(name, start, now());
+				name = nullptr;
+			}
+		}
+
+	private:
+		const char* name;
+		int64_t start;
+	};
+
+	/* Name of the calling thread in the trace (and in the report of the LockProfiler) */
+	static void setThreadName(const std::string& name);
+	/* Number of the calling thread, counted from 1 in the order in which threads were seen */
+	static uint32_t getThreadId() {
+		return getThreadEvents()->id;
+	}
+	static std::string getThreadName(uint32_t id);
+
+	/** Writes the events of all threads in the Chrome trace event format. Can be called at any time from any thread,
+	* recording continues meanwhile. Returns false if the file couldn't be written.*/
+	static bool writeChromeTrace(const std::string& path);
+
+	/* Forgets all recorded events. */
+	static void clear();
+
+	/* Nanoseconds since the profiler started */
+	static int64_t now() {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+	}
+
+	static void record(const char* name, int64_t start, int64_t end);
+
+private:
+	struct Event {
+		const char* name;
+		int64_t start;
+		int64_t duration;
+	};
+	struct ThreadEvents {
+		std::string name;
+		uint32_t id;
+		//allocated on the first event, threads that are only named don't need it
+		std::vector<Event> events;
+		//events ever written, the ring buffer holds the last eventsPerThread of them
+		std::atomic<uint64_t> written = 0;
+		//written when clear() was called, older events are not exported
+		std::atomic<uint64_t> clearedAt = 0;
+	};
+
+	static const std::chrono::steady_clock::time_point epoch;
+	//buffers stay after their thread ended, so that its events can still be exported
+	static std::vector<std::unique_ptr<ThreadEvents>> threads;
+	static std::mutex threadsMtx;
+
+	static ThreadEvents* getThreadEvents();
+};
+
+#ifdef TS_PROFILER
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) Profiler::Scope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_PHASE(variable, name) Profiler::Scope variable(name)
+#define PROFILE_END(variable) variable.end()
+#else
+#define PROFILE_SCOPE(name)
+#define PROFILE_PHASE(variable, name)
+#define PROFILE_END(variable)
+#endif
+
+#if defined(TS_PROFILER) || defined(TS_LOCK_PROFILER)
+#define PROFILE_THREAD(name) Profiler::setThreadName(name)
+#else
+#define PROFILE_THREAD(name)
+#endif
\ No newline at end of file
@@ -0,0 +1,217 @@
+#include "RenderBackend.hpp"
+#include "ShapeBatcher.hpp"
+#include <cmath>
+#include <algorithm>
+
+//Default primitives----------------------------------------------------------------------------------------------------------------------------
+
+void RenderBackend::fillRect(const sf::FloatRect& rect, sf::Color color) {
+	sf::Vector2f corners[4] = {
+		sf::Vector2f(rect.left, rect.top), sf::Vector2f(rect.left + rect.width, rect.top),
+		sf::Vector2f(rect.left + rect.width, rect.top + rect.height), sf::Vector2f(rect.left, rect.top + rect.height)
+	};
+	fillPolygon(corners, 4, color);
+}
+
+void RenderBackend::fillCircle(sf::Vector2f center, float radius, sf::Color color) {
+	constexpr size_t pointCount = 30;//same as sf::CircleShape
+	sf::Vector2f circle[pointCount];
+	for (size_t i = 0; i < pointCount; i++) {
+		float angle = i * 2.0f * 3.14159265f / pointCount;
+		circle[i] = center + sf::Vector2f(std::cos(angle) * radius, std::sin(angle) * radius);
+	}
+	fillPolygon(circle, pointCount, color);
+}
+
+void RenderBackend::drawLine(sf::Vector2f from, sf::Vector2f to, float thickness, sf::Color color) {
+	sf::Vector2f direction = to - from;
+	float length = std::sqrt(direction.x * direction.x + direction.y * direction.y);
+	if (length == 0.0f) {
+		return;
+	}
+	sf::Vector2f offset = sf::Vector2f(-direction.y, direction.x) * (thickness / 2.0f / length);
+	sf::Vector2f corners[4] = { from + offset, to + offset, to - offset, from - offset };
+	fillPolygon(corners, 4, color);
+}
+
+void RenderBackend::drawTexturedQuad(const sf::Vector2f* corners, const sf::IntRect& source, const sf::Texture* texture, sf::Color tint) {
+	float left = (float)source.left, top = (float)source.top;
+	float right = left + source.width, bottom = top + source.height;
+	sf::Vector2f quadTexCoords[4] = { sf::Vector2f(left, top), sf::Vector2f(right, top), sf::Vector2f(right, bottom), sf::Vector2f(left, bottom) };
+	drawTexturedPolygon(corners, quadTexCoords, 4, texture, tint);
+}
+
+void RenderBackend::drawGlyphRun(const sf::Vertex* vertices, size_t vertexCount, const sf::Texture* glyphTexture, bool glyphsAdded) {
+	sf::Vector2f quad[4], quadTexCoords[4];
+	for (size_t i = 0; i + 3 < vertexCount; i += 4) {
+		for (size_t k = 0; k < 4; k++) {
+			quad[k] = vertices[i + k].position;
+			quadTexCoords[k] = vertices[i + k].texCoords;
+		}
+		drawTexturedPolygon(quad, quadTexCoords, 4, glyphTexture, vertices[i].color);
+	}
+}
+
+//Decomposing drawables------------------------------------------------------------------------------------------------------------------------
+
+void RenderBackend::drawDrawable(const sf::Drawable& drawable, const sf::Shape* shape) {
+	if (shape != nullptr) {
+		drawShape(*shape);
+		return;
+	}
+	const sf::Text* text = dynamic_cast<const sf::Text*>(&drawable);
+	if (text != nullptr) {
+		drawText(*text);
+	}
+	//ts:: only creates shapes and texts, everything else is not supported
+}
+
+void RenderBackend::drawShape(const sf::Shape& shape) {
+	size_t count = shape.getPointCount();
+	if (count < 3) {//sf::Shape doesn't draw these either
+		return;
+	}
+	points.resize(count);
+	transformedPoints.resize(count);
+	sf::Transform transform = viewTransform * shape.getTransform();
+	sf::Vector2f min = shape.getPoint(0), max = min;
+	for (size_t i = 0; i < count; i++) {
+		points[i] = shape.getPoint(i);
+		transformedPoints[i] = transform.transformPoint(points[i]);
+		min.x = std::min(min.x, points[i].x); min.y = std::min(min.y, points[i].y);
+		max.x = std::max(max.x, points[i].x); max.y = std::max(max.y, points[i].y);
+	}
+	sf::FloatRect insideBounds(min.x, min.y, max.x - min.x, max.y - min.y);
+	sf::Vector2f center(insideBounds.left + insideBounds.width / 2, insideBounds.top + insideBounds.height / 2);
+
+	//matrix is column major: 0/1 is the transformed x axis, 4/5 the transformed y axis
+	const float* matrix = transform.getMatrix();
+	bool axisAligned = matrix[1] == 0.0f && matrix[4] == 0.0f;
+	sf::Color color = shape.getFillColor();
+	const sf::Texture* texture = shape.getTexture();
+
+	if (texture != nullptr) {
+		const sf::IntRect& textureRect = shape.getTextureRect();
+		if (count == 4 && dynamic_cast<const sf::RectangleShape*>(&shape) != nullptr) {
+			drawTexturedQuad(transformedPoints.data(), textureRect, texture, color);
+		}
+		else {
+			//same mapping as sf::Shape: the inside bounds are stretched over the texture rect
+			texCoords.resize(count);
+			for (size_t i = 0; i < count; i++) {
+				float xRatio = insideBounds.width > 0 ? (points[i].x - insideBounds.left) / insideBounds.width : 0;
+				float yRatio = insideBounds.height > 0 ? (points[i].y - insideBounds.top) / insideBounds.height : 0;
+				texCoords[i] = sf::Vector2f(textureRect.left + textureRect.width * xRatio, textureRect.top + textureRect.height * yRatio);
+			}
+			drawTexturedPolygon(transformedPoints.data(), texCoords.data(), count, texture, color);
+		}
+	}
+	else if (count == 4 && axisAligned == true && dynamic_cast<const sf::RectangleShape*>(&shape) != nullptr) {
+		sf::FloatRect rect = transform.transformRect(insideBounds);
+		fillRect(rect, color);
+	}
+	else if (dynamic_cast<const sf::CircleShape*>(&shape) != nullptr && axisAligned == true && matrix[0] == matrix[5]) {
+		const sf::CircleShape& circle = static_cast<const sf::CircleShape&>(shape);
+		fillCircle(transform.transformPoint(sf::Vector2f(circle.getRadius(), circle.getRadius())), circle.getRadius() * std::abs(matrix[0]), color);
+	}
+	else {
+		fillPolygon(transformedPoints.data(), count, color);
+	}
+	primitiveCount++;
+
+	if (shape.getOutlineThickness() != 0) {
+		drawOutline(shape, center);
+	}
+}
+
+void RenderBackend::drawOutline(const sf::Shape& shape, sf::Vector2f center) {
+	sf::Color color = shape.getOutlineColor();
+	sf::Transform transform = viewTransform * shape.getTransform();
+	size_t count = points.size();
+	ShapeBatcher::computeOutline(points, center, shape.getOutlineThickness(), outerPoints);
+	for (size_t i = 0; i < count; i++) {
+		outerPoints[i] = transform.transformPoint(outerPoints[i]);
+	}
+
+	//every edge becomes a convex quad
+	for (size_t i = 0; i < count; i++) {
+		size_t next = (i + 1) % count;
+		sf::Vector2f quad[4] = { transformedPoints[i], outerPoints[i], outerPoints[next], transformedPoints[next] };
+		fillPolygon(quad, 4, color);
+		primitiveCount++;
+	}
+}
+
+void RenderBackend::drawText(const sf::Text& text) {
+	const sf::Font* font = text.getFont();
+	const sf::String& string = text.getString();
+	if (font == nullptr || string.isEmpty() == true) {
+		return;
+	}
+	unsigned int size = text.getCharacterSize();
+	bool bold = (text.getStyle() & sf::Text::Bold) != 0;
+	float italicShear = (text.getStyle() & sf::Text::Italic) != 0 ? 0.209f : 0.0f;//12 degrees, like sf::Text
+	sf::Color color = text.getFillColor();
+	sf::Transform transform = viewTransform * text.getTransform();
+	const sf::Texture* texture = &font->getTexture(size);
+	std::unordered_set<uint64_t>& known = knownGlyphs[texture];
+	bool glyphsAdded = false;
+
+	//same layout as sf::Text::ensureGeometryUpdate, without underlines, strike throughs and outlines
+	float whitespaceWidth = font->getGlyph(L' ', size, bold).advance;
+	float letterSpacing = (whitespaceWidth / 3.f) * (text.getLetterSpacing() - 1.f);
+	whitespaceWidth += letterSpacing;
+	float lineSpacing = font->getLineSpacing(size) * text.getLineSpacing();
+	float x = 0.f;
+	float y = (float)size;
+
+	glyphVertices.clear();
+	sf::Uint32 previous = 0;
+	for (size_t i = 0; i < string.getSize(); i++) {
+		sf::Uint32 current = string[i];
+		if (current == L'\r') {
+			continue;
+		}
+		x += font->getKerning(previous, current, size);
+		previous = current;
+		if (current == L' ') {
+			x += whitespaceWidth;
+			continue;
+		}
+		if (current == L'\t') {
+			x += whitespaceWidth * 4;
+			continue;
+		}
+		if (current == L'\n') {
+			y += lineSpacing;
+			x = 0;
+			continue;
+		}
+
+		const sf::Glyph& glyph = font->getGlyph(current, size, bold);
+		if (known.insert(((uint64_t)current << 1) | (bold ? 1 : 0)).second == true) {
+			glyphsAdded = true;
+		}
+		float padding = 1.0f;
+		float left = glyph.bounds.left - padding;
+		float top = glyph.bounds.top - padding;
+		float right = glyph.bounds.left + glyph.bounds.width + padding;
+		float bottom = glyph.bounds.top + glyph.bounds.height + padding;
+		float u1 = glyph.textureRect.left - padding;
+		float v1 = glyph.textureRect.top - padding;
+		float u2 = glyph.textureRect.left + glyph.textureRect.width + padding;
+		float v2 = glyph.textureRect.top + glyph.textureRect.height + padding;
+
+		glyphVertices.push_back(sf::Vertex(transform.transformPoint(x + left - italicShear * top, y + top), color, sf::Vector2f(u1, v1)));
+		glyphVertices.push_back(sf::Vertex(transform.transformPoint(x + right - italicShear * top, y + top), color, sf::Vector2f(u2, v1)));
+		glyphVertices.push_back(sf::Vertex(transform.transformPoint(x + right - italicShear * bottom, y + bottom), color, sf::Vector2f(u2, v2)));
+		glyphVertices.push_back(sf::Vertex(transform.transformPoint(x + left - italicShear * bottom, y + bottom), color, sf::Vector2f(u1, v2)));
+
+		x += glyph.advance + letterSpacing;
+	}
+	if (glyphVertices.empty() == false) {
+		//the font texture of this size may have been resized while adding glyphs, so it is asked for again
+		drawGlyphRun(glyphVertices.data(), glyphVertices.size(), &font->getTexture(size), glyphsAdded);
+		primitiveCount++;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+#pragma once
+#include <vector>
+#include <map>
+#include <unordered_set>
+#include <cstdint>
+#include "SFML/Graphics.hpp"
+
+/** Primitive drawing operations that a frame of the Renderer is made of. The default frame pipeline draws with SFML directly,
+* if a backend is set (see Renderer::setRenderBackend), every drawable of the snapshot is decomposed into these primitives instead.
+* Coordinates are in screen pixels, polygons are convex. All calls come from the rendering thread.*/
+class RenderBackend {
+public:
+	virtual ~RenderBackend() {}
+
+	/* Starts a new frame cleared to "clearColor". */
+	virtual void beginFrame(sf::Color clearColor) = 0;
+	/* Finishes the frame, after this it is the one returned by getFramebuffer(). */
+	virtual void present() = 0;
+	virtual sf::Vector2u getSize() = 0;
+
+	virtual void fillPolygon(const sf::Vector2f* points, size_t count, sf::Color color) = 0;
+	/* Every pixel is the texel at the texture coordinates (in pixels of "texture") interpolated between the points, multiplied with "tint". */
+	virtual void drawTexturedPolygon(const sf::Vector2f* points, const sf::Vector2f* texCoords, size_t count, const sf::Texture* texture, sf::Color tint) = 0;
+
+	//Special cases, by default drawn as polygons. Override them if the backend has a faster way.
+	virtual void fillRect(const sf::FloatRect& rect, sf::Color color);
+	virtual void fillCircle(sf::Vector2f center, float radius, sf::Color color);
+	virtual void drawLine(sf::Vector2f from, sf::Vector2f to, float thickness, sf::Color color);
+	/* "corners" in the order top left, top right, bottom right, bottom left of "source". */
+	virtual void drawTexturedQuad(const sf::Vector2f* corners, const sf::IntRect& source, const sf::Texture* texture, sf::Color tint);
+	/** Quads of 4 vertices each (see sf::Text). "glyphsAdded" is true if the font rendered new glyphs into "glyphTexture" since it was last used,
+	* so copies of it are outdated.*/
+	virtual void drawGlyphRun(const sf::Vertex* vertices, size_t vertexCount, const sf::Texture* glyphTexture, bool glyphsAdded);
+
+	/* Called whenever the Renderer loaded "image" into "rect" of "texture", so that backends which can't read textures back keep their own copy. */
+	virtual void onTextureLoaded(const sf::Texture* texture, const sf::IntRect& rect, const sf::Image& image) {}
+
+	//Backends that keep their last frame can redraw only what changed. By default every frame is drawn completely.
+	/* "area" changed since the last frame. Called before beginFrame for everything that changed, was added or removed. */
+	virtual void markDirty(const sf::FloatRect& area) {}
+	/* The whole next frame has to be redrawn, e.g. because the backend wasn't used for a while. */
+	virtual void markAllDirty() {}
+	/* False if nothing inside of "area" is redrawn this frame, drawables in there don't have to be drawn then. */
+	virtual bool isDirty(const sf::FloatRect& area) {
+		return true;
+	}
+	/* Appends the pixel rects of the framebuffer that changed in the last present(). */
+	virtual void getChangedRects(std::vector<sf::IntRect>& rects) {
+		rects.push_back(sf::IntRect(0, 0, (int)getSize().x, (int)getSize().y));
+	}
+
+	/* RGBA pixels of the last presented frame, nullptr if the backend doesn't draw into memory. */
+	virtual const sf::Uint8* getFramebuffer() {
+		return nullptr;
+	}
+
+	/* Draws a front buffer of the snapshot with the primitives above. "shape" is the same object if it is an sf::Shape, nullptr otherwise. */
+	void drawDrawable(const sf::Drawable& drawable, const sf::Shape* shape);
+
+	/* Maps world coordinates of the drawables to screen pixels (see ts::Camera), applied by drawDrawable before the primitives are called. */
+	void setViewTransform(const sf::Transform& transform) {
+		viewTransform = transform;
+	}
+
+	//Primitives drawn since the last beginFrame
+	unsigned int getPrimitiveCount() {
+		return primitiveCount;
+	}
+
+protected:
+	unsigned int primitiveCount = 0;
+
+private:
+	sf::Transform viewTransform;
+	//reused between drawables so that decomposing doesn't allocate
+	std::vector<sf::Vector2f> points, transformedPoints, texCoords, outerPoints;
+	std::vector<sf::Vertex> glyphVertices;
+	//glyphs that were already in each font texture, to notice when a font renders new ones
+	std::map<const sf::Texture*, std::unordered_set<uint64_t>> knownGlyphs;
+
+	void drawShape(const sf::Shape& shape);
+	void drawOutline(const sf::Shape& shape, sf::Vector2f center);
+	void drawText(const sf::Text& text);
+};
\ No newline at end of file
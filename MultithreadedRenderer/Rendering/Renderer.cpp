@@ -3,9 +3,73 @@
 
 //Static defines------------------------------------------------------------------------------------------------------------------------------
 
-sf::RenderWindow* Renderer::window;
+sf::RenderWindow* Renderer::window = nullptr;
 int Renderer::xPixels;
 int Renderer::yPixels;
+sf::ContextSettings Renderer::contextSettings;
+bool Renderer::headless = false;
+sf::RenderTexture* Renderer::offscreenTarget = nullptr;
+double Renderer::frameClock = 0.0;
+RenderBackend* Renderer::backend = nullptr;
+sf::Texture* Renderer::backendPresentTexture = nullptr;
+std::vector<sf::IntRect> Renderer::backendChangedRects;
+std::vector<sf::Uint8> Renderer::backendUploadBuffer;
+std::chrono::steady_clock::time_point Renderer::frameClockStart = std::chrono::steady_clock::now();
+
+//Event loop----------------------------------------------------------------------------------------------------------------------------------
+
+TickScheduler Renderer::tickScheduler(60.0, 5);
+SleepAPI Renderer::eventloopSleeper;
+SleepAPI Renderer::frameSleeper;
+std::atomic<int64_t> Renderer::frameIntervalMicroseconds = 1000000 / 60;
+std::atomic<uint64_t> Renderer::completedTicks = 0;
+std::atomic<int64_t> Renderer::lastTickMicroseconds = 0;
+std::atomic<bool> Renderer::interpolationEnabled = false;
+
+float Renderer::getTickAlpha() {
+	if (headless == true) {//no ticks to interpolate between, show the latest state
+		return 1.0f;
+	}
+	int64_t now = std::chrono::duration_cast<std::chrono::microseconds>(TickScheduler::Clock::now().time_since_epoch()).count();
+	int64_t interval = std::chrono::duration_cast<std::chrono::microseconds>(tickScheduler.getTickInterval()).count();
+	if (interval <= 0) {
+		return 1.0f;
+	}
+	return std::clamp((float)(now - lastTickMicroseconds.load()) / (float)interval, 0.0f, 1.0f);
+}
+
+void Renderer::handleEventsUntil(TickScheduler::Clock::time_point deadline) {
+	PROFILE_SCOPE("handleEventsUntil");
+	sf::Event eventCatcher{};
+	while (true) {
+		bool receivedEvents = false;
+		while (window->pollEvent(eventCatcher)) {
+			receivedEvents = true;
+			if (eventCatcher.type == sf::Event::Closed) {
+				window->close();
+				requestRedraw();
+				return;
+			}
+		}
+		if (receivedEvents == true) {//resizes, focus changes etc. need a new frame even if no drawable changed
+			requestRedraw();
+		}
+
+		auto now = TickScheduler::Clock::now();
+		if (now >= deadline) {
+			return;
+		}
+		//SFML can't wait for events with a timeout, so we wait in short slices and look for new events in between.
+		//Only the last slice ends exactly at the deadline, the ones before are plain sleeps that neither spin nor count in the statistics.
+		//They stop early enough that oversleeping a bit can't miss the start of the spinning.
+		if (deadline - now > std::chrono::milliseconds(1) + eventloopSleeper.getSpinThreshold()) {
+			eventloopSleeper.osSleepUntil(now + std::chrono::milliseconds(1));
+		}
+		else {
+			eventloopSleeper.sleepUntil(deadline);
+		}
+	}
+}
 
 //Multithreading------------------------------------------------------------------------------------------------------------------------------
 std::thread* Renderer::renderingThread;
@@ -15,84 +79,670 @@ void Renderer::joinDrawingThread() {
 }
 
 void Renderer::threadInit() {
+	PROFILE_THREAD("Rendering");
 	window->setActive(true);
 	loop();
 }
 
 void Renderer::loop() {
+	SleepAPI::Clock::time_point nextFrame = SleepAPI::Clock::now();
 	while (window->isOpen()) {
+		if (onDemandRedraw.load() == true) {
+			waitForRedrawRequest();
+		}
+		//frame limiter: wait for the start of this frame's slot
+		int64_t frameInterval = frameIntervalMicroseconds.load();
+		if (frameInterval > 0) {
+			auto now = SleepAPI::Clock::now();
+			if (nextFrame > now) {
+				PROFILE_SCOPE("frameLimiter");
+				frameSleeper.sleepUntil(nextFrame);
+				nextFrame += std::chrono::microseconds(frameInterval);
+			}
+			else {//too late (or idle in on-demand mode), don't try to catch up with frames in quick succession
+				nextFrame = now + std::chrono::microseconds(frameInterval);
+			}
+		}
 		drawFrame();
 	}
 }
 
+std::atomic<bool> Renderer::onDemandRedraw = false;
+std::atomic<bool> Renderer::redrawRequested = true;
+std::atomic<int64_t> Renderer::idleRedrawMicroseconds = 1000000;
+std::mutex Renderer::redrawMtx;
+std::condition_variable Renderer::redrawCondition;
+
+void Renderer::waitForRedrawRequest() {
+	PROFILE_SCOPE("waitForRedrawRequest");
+	auto shouldDraw = [] { return redrawRequested.load() == true || window->isOpen() == false || onDemandRedraw.load() == false; };
+	std::unique_lock<std::mutex> lock(redrawMtx);
+	int64_t idleMicroseconds = idleRedrawMicroseconds.load();
+	if (idleMicroseconds > 0) {
+		redrawCondition.wait_for(lock, std::chrono::microseconds(idleMicroseconds), shouldDraw);
+	}
+	else {
+		redrawCondition.wait(lock, shouldDraw);
+	}
+}
+
 //Drawing--------------------------------------------------------------------------------------------------------------------------------------
 
-std::vector<ts::Drawable*> Renderer::permanentObjects;
-std::mutex Renderer::permanentObjectMtx;
-std::vector<ts::Drawable*> Renderer::changedObjects;
-std::mutex Renderer::changedObjectMtx;
-std::mutex Renderer::drawingMtx;
+std::map<int, DrawLayer> Renderer::permanentObjects;
+ProfiledMutex Renderer::permanentObjectMtx("Renderer::permanentObjectMtx");
+MPSCQueue<ChangedObject, 65536> Renderer::changedObjects;
+std::atomic<bool> Renderer::changedObjectsOverflowed = false;
+std::unordered_map<uint64_t, size_t> Renderer::droppedChanges;
+TweenEngine Renderer::tweenEngine;
+std::unordered_map<uint64_t, size_t> Renderer::droppedTweenTargets;
+KinematicSystem Renderer::kinematics;
+ProfiledMutex Renderer::kinematicsMtx("Renderer::kinematicsMtx");
+ProfiledMutex Renderer::drawingMtx("Renderer::drawingMtx");
+std::vector<SnapshotEntry> Renderer::sceneSnapshot;
+ShapeBatcher Renderer::batcher;
+std::atomic<bool> Renderer::batchingEnabled = true;
+std::atomic<unsigned int> Renderer::lastFrameDrawCalls = 0;
+std::vector<sf::Drawable*> Renderer::retiredFrontBuffers;
+ProfiledMutex Renderer::retiredFrontBufferMtx("Renderer::retiredFrontBufferMtx");
 
-void Renderer::drawFrame() {
-	loadAllTextures();
-	window->clear();
+void DrawLayer::add(ts::Drawable* object) {
+	object->registrySlot = (int)objects.size();
+	objects.push_back(object);
+}
+
+void DrawLayer::remove(ts::Drawable* object) {
+	objects[object->registrySlot] = nullptr;
+	object->registrySlot = -1;
+	removed++;
+}
+
+void DrawLayer::compact() {
+	size_t kept = 0;
+	for (size_t i = 0; i < objects.size(); i++) {
+		if (objects[i] != nullptr) {
+			objects[kept] = objects[i];
+			objects[kept]->registrySlot = (int)kept;
+			kept++;
+		}
+	}
+	objects.resize(kept);
+	removed = 0;
+}
+
+void Renderer::takeSceneSnapshot() {
+	PROFILE_SCOPE("takeSceneSnapshot");
+	//the previous snapshot is the only place that can still reference retired front buffers
+	sceneSnapshot.clear();
+	retiredFrontBufferMtx.lock();
+	for (unsigned int i = 0; i < retiredFrontBuffers.size(); i++) {
+		delete retiredFrontBuffers[i];
+	}
+	retiredFrontBuffers.clear();
+	retiredFrontBufferMtx.unlock();
+	updateFrameCamera();
+	bool culling = cullingEnabled.load();
+
+	PROFILE_PHASE(lockPhase, "lockDrawables");
 	drawingMtx.lock();
+	permanentObjectMtx.lock();
+	for (auto it = permanentObjects.begin(); it != permanentObjects.end(); ) {
+		DrawLayer& layer = it->second;
+		//only compact once a quarter of the slots are empty, so that mass deletion stays amortized O(1) per drawable
+		if (layer.removed * 4 > layer.objects.size()) {
+			layer.compact();
+		}
+		if (layer.objects.empty() == true) {
+			it = permanentObjects.erase(it);
+			continue;
+		}
+		//lock all drawables before copying, so that the snapshot is at the transformation state of the same frame.
+		for (unsigned int i = 0; i < layer.objects.size(); i++) {
+			if (layer.objects[i] != nullptr) {
+				layer.objects[i]->lock();
+			}
+		}
+		++it;
+	}
+
+	PROFILE_END(lockPhase);
 
 	//apply all changes-------------------------------------------------------------------------------------------------------
-	changedObjectMtx.lock();
-	for (unsigned int i = 0; i < changedObjects.size(); i++) {
-		changedObjects[i]->applyChanges();
+	PROFILE_PHASE(applyPhase, "applyChanges");
+	//Deleted drawables can't be removed from the queue, but they are unregistered under permanentObjectMtx,
+	//so every entry of a deleted drawable was pushed before the position that is stored with its serial in droppedChanges.
+	ChangedObject changed;
+	size_t drained = 0;
+	while (drained < changedObjects.getCapacity() && changedObjects.tryPop(changed) == true) {//bounded so that busy producers can't keep us here forever
+		if (droppedChanges.count(changed.serial) == 0) {
+			changed.object->applyChanges();
+		}
+		drained++;
+	}
+	//entries of a dropped drawable can still sit behind a slot that isn't published yet
+	size_t drainedUntil = changedObjects.getDequeuePosition();
+	for (auto it = droppedChanges.begin(); it != droppedChanges.end();) {
+		if ((intptr_t)(it->second - drainedUntil) <= 0) {
+			it = droppedChanges.erase(it);
+		}
+		else {
+			++it;
+		}
 	}
-	changedObjects.clear();
-	changedObjectMtx.unlock();
 
-	//draw permanent objects---------------------------------------------------------------------------------------------------
-	permanentObjectMtx.lock();
-	//lock all drawables before drawing, so that they are at the transformation state of the same frame.
-	for (unsigned int i = 0; i < permanentObjects.size(); i++) {
-		permanentObjects[i]->lock();
+	if (changedObjectsOverflowed.exchange(false, std::memory_order_acq_rel) == true) {
+		for (auto& [key, layer] : permanentObjects) {
+			for (unsigned int i = 0; i < layer.objects.size(); i++) {
+				if (layer.objects[i] != nullptr && layer.objects[i]->isQueuedForChanges() == true) {
+					layer.objects[i]->applyChanges();
+				}
+			}
+		}
 	}
 
-	for (unsigned int i = 0; i < permanentObjects.size(); i++) {
-		if (permanentObjects[i]->isShown() == true) {
-			permanentObjects[i]->draw();
+	PROFILE_END(applyPhase);
+
+	//advance animations------------------------------------------------------------------------------------------------------
+	PROFILE_PHASE(animationPhase, "advanceAnimations");
+	tweenEngine.update(frameClock, droppedTweenTargets);
+	//an add command for a dropped target can still sit behind a command slot that isn't published yet
+	size_t executedUntil = tweenEngine.getExecutedPosition();
+	for (auto it = droppedTweenTargets.begin(); it != droppedTweenTargets.end();) {
+		if ((intptr_t)(it->second - executedUntil) <= 0) {
+			it = droppedTweenTargets.erase(it);
+		}
+		else {
+			++it;
 		}
-		permanentObjects[i]->unlock();
 	}
-	permanentObjectMtx.unlock();
+	bool animating = tweenEngine.getActiveCount() > 0;
+	kinematicsMtx.lock();
+	kinematics.integrate(frameClock);
+	animating = animating || kinematics.getCount() > 0;
 
+	PROFILE_END(animationPhase);
+
+	//copy changed drawables into their front buffers---------------------------------------------------------------------------
+	PROFILE_PHASE(copyPhase, "copyFrontBuffers");
+	//headless frames aren't driven by ticks, there is nothing to interpolate between
+	bool interpolation = interpolationEnabled.load() == true && headless == false;
+	uint64_t latestTick = completedTicks.load();
+	float alpha = getTickAlpha();
+	bool interpolated = false;
+	for (auto& [key, layer] : permanentObjects) {
+		for (unsigned int i = 0; i < layer.objects.size(); i++) {
+			ts::Drawable* object = layer.objects[i];
+			if (object == nullptr) {
+				continue;
+			}
+			bool changed = object->changedSinceSnapshot.exchange(false, std::memory_order_acq_rel);
+			if (changed == true) {
+				object->swapBuffers();
+			}
+			if (interpolation == true && object->interpolate(latestTick, alpha) == true) {
+				changed = true;
+				interpolated = true;
+			}
+			if (object->kinematicSlot != -1) {//the motion overrides the position of the back buffer
+				object->writeMotionToFront(kinematics.getState(object->kinematicSlot));
+				changed = true;
+			}
+			if (changed == true) {
+				//the old and the new area of the drawable have to be redrawn
+				if (object->snapshotShown == true) {
+					addDirtyRegion(object->snapshotBounds);
+				}
+				object->snapshotShown = object->isShown();
+				object->snapshotBounds = object->frontBounds;
+				if (object->snapshotShown == true) {
+					addDirtyRegion(object->snapshotBounds);
+					object->cullingCells = cullingGrid.move(object, object->cullingCells, object->snapshotBounds);
+				}
+				else {
+					cullingGrid.remove(object, object->cullingCells);
+					object->cullingCells = GridCellRange();
+				}
+			}
+			if (culling == false && object->snapshotShown == true) {
+				sceneSnapshot.push_back(SnapshotEntry{ object->frontBuffer, object->accessFrontShape(), object->snapshotBounds });
+			}
+			object->unlock();
+		}
+	}
+	kinematicsMtx.unlock();
+	PROFILE_END(copyPhase);
+	if (culling == true) {
+		collectVisibleObjects();
+	}
+	lastFrameVisibleObjects.store((unsigned int)sceneSnapshot.size());
+
+	takeFrameDirtyAreas();
+	if (interpolated == true || animating == true) {//keeps on-demand mode drawing while something interpolates, is animated or moves
+		requestRedraw();
+	}
+	permanentObjectMtx.unlock();
 	drawingMtx.unlock();
-	window->display();
+}
+
+//Culling--------------------------------------------------------------------------------------------------------------------------------------
+
+ts::Camera Renderer::camera;
+SpatialGrid<ts::Drawable*> Renderer::cullingGrid;
+std::atomic<bool> Renderer::cullingEnabled = true;
+std::atomic<unsigned int> Renderer::lastFrameVisibleObjects = 0;
+std::vector<ts::Drawable*> Renderer::visibleObjects;
+uint64_t Renderer::frameCameraVersion = 0;
+bool Renderer::frameCameraChanged = false;
+sf::View Renderer::frameView;
+sf::FloatRect Renderer::frameWorldBounds;
+sf::Transform Renderer::frameViewToPixels;
+
+void Renderer::updateFrameCamera() {
+	uint64_t version = camera.getVersion();
+	frameCameraChanged = version != frameCameraVersion;
+	if (frameCameraChanged == false) {
+		return;
+	}
+	frameCameraVersion = version;
+	frameView = camera.getView();
+	//the view maps the visible area to -1..1 with y pointing up
+	frameWorldBounds = frameView.getInverseTransform().transformRect(sf::FloatRect(-1.0f, -1.0f, 2.0f, 2.0f));
+	float width = (float)xPixels, height = (float)yPixels;
+	frameViewToPixels = sf::Transform(width / 2.0f, 0.0f, width / 2.0f, 0.0f, -height / 2.0f, height / 2.0f, 0.0f, 0.0f, 1.0f) * frameView.getTransform();
+}
+
+void Renderer::collectVisibleObjects() {
+	PROFILE_SCOPE("collectVisibleObjects");
+	visibleObjects.clear();
+	cullingGrid.query(frameWorldBounds, [](ts::Drawable* object, const sf::FloatRect& bounds) {
+		visibleObjects.push_back(object);
+	});
+	//the grid has no order, the drawing order is the order of the layers and of the slots in them
+	std::sort(visibleObjects.begin(), visibleObjects.end(), [](const ts::Drawable* a, const ts::Drawable* b) {
+		return a->layer != b->layer ? a->layer < b->layer : a->registrySlot < b->registrySlot;
+	});
+	for (size_t i = 0; i < visibleObjects.size(); i++) {
+		ts::Drawable* object = visibleObjects[i];
+		sceneSnapshot.push_back(SnapshotEntry{ object->frontBuffer, object->accessFrontShape(), object->snapshotBounds });
+	}
+}
+
+sf::RenderTarget* Renderer::getRenderTarget() {
+	if (headless == true) {
+		return offscreenTarget;
+	}
+	return window;
+}
+
+void Renderer::presentFrame() {
+	PROFILE_SCOPE("display");
+	if (headless == true) {
+		offscreenTarget->display();
+	}
+	else {
+		window->display();
+	}
+}
+
+void Renderer::stepFrame(sf::Time frameTime) {
+	if (offscreenTarget != nullptr) {
+		offscreenTarget->setActive(true);
+	}
+	frameClock += frameTime.asSeconds();
+	drawFrame();
+}
+
+void Renderer::drawFrame() {
+	PROFILE_SCOPE("drawFrame");
+	//cleared before anything is read, so that every change from now on requests the next frame
+	redrawRequested.store(false);
+	if (headless == false) {
+		frameClock = std::chrono::duration<double>(std::chrono::steady_clock::now() - frameClockStart).count();
+	}
+	loadAllTextures();
+	takeSceneSnapshot();
+
+	//draw the snapshot without holding any locks, the game thread can keep changing the drawables in the meantime.
+	if (backend != nullptr) {
+		drawWithBackend();
+	}
+	else if (dirtyRectRedraw.load() == true) {
+		drawDirtyRegion();
+	}
+	else {
+		if (sceneBuffer != nullptr) {//would be outdated when dirty rectangles are enabled again
+			delete sceneBuffer;
+			sceneBuffer = nullptr;
+		}
+		getRenderTarget()->clear();
+		getRenderTarget()->setView(frameView);
+		drawSnapshot(getRenderTarget(), nullptr);
+		getRenderTarget()->setView(getRenderTarget()->getDefaultView());
+		presentFrame();
+	}
+}
+
+void Renderer::drawWithBackend() {
+	PROFILE_PHASE(rasterizePhase, "backendDraw");
+	if (frameCameraChanged == true) {//everything moved on screen
+		backend->markAllDirty();
+	}
+	for (size_t i = 0; i < frameDirtyAreas.size(); i++) {
+		backend->markDirty(frameDirtyAreas[i]);
+	}
+	backend->setViewTransform(frameViewToPixels);
+	backend->beginFrame(sf::Color::Black);
+	for (unsigned int i = 0; i < sceneSnapshot.size(); i++) {
+		if (backend->isDirty(frameViewToPixels.transformRect(sceneSnapshot[i].bounds)) == true) {
+			backend->drawDrawable(*sceneSnapshot[i].drawable, sceneSnapshot[i].shape);
+		}
+	}
+	backend->present();
+	lastFrameDrawCalls.store(backend->getPrimitiveCount());
+	PROFILE_END(rasterizePhase);
+
+	//frames drawn into memory are shown by drawing them as one texture
+	const sf::Uint8* framebuffer = backend->getFramebuffer();
+	if (window != nullptr && framebuffer != nullptr) {
+		uploadBackendFrame(framebuffer, backend->getSize());
+		window->clear();
+		window->draw(sf::Sprite(*backendPresentTexture));
+		PROFILE_SCOPE("display");
+		window->display();
+	}
+}
+
+void Renderer::uploadBackendFrame(const sf::Uint8* framebuffer, sf::Vector2u size) {
+	PROFILE_SCOPE("uploadBackendFrame");
+	if (backendPresentTexture == nullptr || backendPresentTexture->getSize() != size) {
+		delete backendPresentTexture;
+		backendPresentTexture = new sf::Texture();
+		backendPresentTexture->create(size.x, size.y);
+		backendPresentTexture->update(framebuffer);
+		return;
+	}
+	backendChangedRects.clear();
+	backend->getChangedRects(backendChangedRects);
+	for (size_t i = 0; i < backendChangedRects.size(); i++) {
+		const sf::IntRect& rect = backendChangedRects[i];
+		const sf::Uint8* rows = &framebuffer[((size_t)rect.top * size.x + rect.left) * 4];
+		if ((unsigned int)rect.width != size.x) {//rows of a narrower rect aren't next to each other in the framebuffer
+			size_t rowBytes = (size_t)rect.width * 4;
+			backendUploadBuffer.resize(rowBytes * rect.height);
+			for (int y = 0; y < rect.height; y++) {
+				std::copy(rows + (size_t)y * size.x * 4, rows + (size_t)y * size.x * 4 + rowBytes, &backendUploadBuffer[rowBytes * y]);
+			}
+			rows = backendUploadBuffer.data();
+		}
+		backendPresentTexture->update(rows, rect.width, rect.height, rect.left, rect.top);
+	}
+}
+
+void Renderer::drawSnapshot(sf::RenderTarget* target, const sf::FloatRect* clip) {
+	PROFILE_SCOPE("drawSnapshot");
+	bool batching = batchingEnabled.load();
+	batcher.begin(target);
+	for (unsigned int i = 0; i < sceneSnapshot.size(); i++) {
+		if (clip != nullptr && sceneSnapshot[i].bounds.intersects(*clip) == false) {
+			continue;
+		}
+		if (batching == true && sceneSnapshot[i].shape != nullptr) {
+			batcher.addShape(*sceneSnapshot[i].shape);
+		}
+		else {
+			batcher.addUnbatchable(*sceneSnapshot[i].drawable);
+		}
+	}
+	batcher.end();
+	lastFrameDrawCalls.store(batcher.getDrawCallCount());
+}
+
+//Dirty rectangles--------------------------------------------------------------------------------------------------------------
+
+std::atomic<bool> Renderer::dirtyRectRedraw = false;
+std::atomic<float> Renderer::fullRedrawThreshold = 0.5f;
+sf::RenderTexture* Renderer::sceneBuffer = nullptr;
+std::vector<sf::FloatRect> Renderer::dirtyAreas;
+std::vector<sf::FloatRect> Renderer::frameDirtyAreas;
+sf::FloatRect Renderer::frameDirtyRegion;
+
+void Renderer::addDirtyRegion(const sf::FloatRect& bounds) {
+	if (bounds.width <= 0 || bounds.height <= 0) {
+		return;
+	}
+	dirtyAreas.push_back(bounds);
+}
+
+void Renderer::takeFrameDirtyAreas() {
+	frameDirtyAreas.swap(dirtyAreas);
+	dirtyAreas.clear();
+	frameDirtyRegion = sf::FloatRect();
+	for (size_t i = 0; i < frameDirtyAreas.size(); i++) {
+		//collected in world coordinates, redrawn in window pixels
+		frameDirtyAreas[i] = frameViewToPixels.transformRect(frameDirtyAreas[i]);
+		const sf::FloatRect& area = frameDirtyAreas[i];
+		if (frameDirtyRegion.width <= 0 || frameDirtyRegion.height <= 0) {
+			frameDirtyRegion = area;
+			continue;
+		}
+		float left = std::min(frameDirtyRegion.left, area.left);
+		float top = std::min(frameDirtyRegion.top, area.top);
+		float right = std::max(frameDirtyRegion.left + frameDirtyRegion.width, area.left + area.width);
+		float bottom = std::max(frameDirtyRegion.top + frameDirtyRegion.height, area.top + area.height);
+		frameDirtyRegion = sf::FloatRect(left, top, right - left, bottom - top);
+	}
+}
+
+void Renderer::drawDirtyRegion() {
+	PROFILE_SCOPE("drawDirtyRegion");
+	sf::FloatRect screen(0.0f, 0.0f, (float)xPixels, (float)yPixels);
+	bool redrawAll = false;
+	if (sceneBuffer == nullptr) {//the buffer has no content yet
+		sceneBuffer = new sf::RenderTexture();
+		sceneBuffer->create(xPixels, yPixels, contextSettings);
+		redrawAll = true;
+	}
+	if (frameCameraChanged == true) {//everything moved on screen
+		redrawAll = true;
+	}
+
+	//whole pixels plus a margin for antialiased edges, clipped to the window
+	sf::FloatRect region;
+	if (frameDirtyRegion.width > 0 && frameDirtyRegion.height > 0) {
+		float left = std::floor(frameDirtyRegion.left) - 1.0f;
+		float top = std::floor(frameDirtyRegion.top) - 1.0f;
+		float right = std::ceil(frameDirtyRegion.left + frameDirtyRegion.width) + 1.0f;
+		float bottom = std::ceil(frameDirtyRegion.top + frameDirtyRegion.height) + 1.0f;
+		screen.intersects(sf::FloatRect(left, top, right - left, bottom - top), region);
+	}
+	if (region.width * region.height > fullRedrawThreshold.load() * screen.width * screen.height) {
+		redrawAll = true;
+	}
+
+	if (redrawAll == true) {
+		sceneBuffer->clear();
+		sceneBuffer->setView(frameView);
+		drawSnapshot(sceneBuffer, nullptr);
+		sceneBuffer->setView(sceneBuffer->getDefaultView());
+	}
+	else if (region.width > 0 && region.height > 0) {
+		//a view with the same area as its viewport only lets drawing through inside of the region, which works like a scissor rect
+		sf::FloatRect viewport(region.left / screen.width, region.top / screen.height, region.width / screen.width, region.height / screen.height);
+		sf::View clipView(region);
+		clipView.setViewport(viewport);
+		sceneBuffer->setView(clipView);
+
+		//clear() ignores the viewport, so the region is cleared by overwriting it
+		sf::RectangleShape clearRect(sf::Vector2f(region.width, region.height));
+		clearRect.setPosition(region.left, region.top);
+		clearRect.setFillColor(sf::Color::Black);
+		sceneBuffer->draw(clearRect, sf::RenderStates(sf::BlendNone));
+
+		//the part of the camera's view that is shown in the region, same rotation and zoom
+		sf::Transform pixelsToWorld = frameViewToPixels.getInverse();
+		sf::View cameraClipView(pixelsToWorld.transformPoint(region.left + region.width / 2.0f, region.top + region.height / 2.0f),
+			sf::Vector2f(frameView.getSize().x * viewport.width, frameView.getSize().y * viewport.height));
+		cameraClipView.setRotation(frameView.getRotation());
+		cameraClipView.setViewport(viewport);
+		sceneBuffer->setView(cameraClipView);
+		sf::FloatRect worldRegion = pixelsToWorld.transformRect(region);
+		drawSnapshot(sceneBuffer, &worldRegion);
+		sceneBuffer->setView(sceneBuffer->getDefaultView());
+	}
+	else {
+		lastFrameDrawCalls.store(0);
+	}
+	sceneBuffer->display();
+
+	getRenderTarget()->clear();
+	getRenderTarget()->draw(sf::Sprite(sceneBuffer->getTexture()));
+	presentFrame();
 }
 
 //Textures-------------------------------------------------------------------------------------------------------------
 
-std::map<std::string, sf::Texture*> Renderer::loadedTextures;
+std::map<std::string, LoadedTexture> Renderer::loadedTextures;
 std::vector<TexturedObjectToLoad> Renderer::texturesToLoad;
-std::mutex Renderer::loadingMtx;
+std::map<std::string, std::vector<TexturedObjectToLoad>> Renderer::texturesInDecoding;
+ProfiledMutex Renderer::loadingMtx("Renderer::loadingMtx");
+std::vector<DecodedTexture> Renderer::decodedTextures;
+ProfiledMutex Renderer::decodedTextureMtx("Renderer::decodedTextureMtx");
+ThreadPool* Renderer::loadingPool = nullptr;
+TextureAtlas Renderer::atlas;
+std::atomic<bool> Renderer::atlasEnabled = true;
+std::vector<DecodedTexture> Renderer::pendingUploads;
+std::atomic<int64_t> Renderer::uploadBudgetMicroseconds = 2000;
+std::atomic<size_t> Renderer::uploadBudgetBytes = 8 * 1024 * 1024;
 void Renderer::loadAllTextures() {
+	PROFILE_SCOPE("loadAllTextures");
+	//take everything that finished decoding first, the loading pool can keep adding in the meantime
+	decodedTextureMtx.lock();
+	pendingUploads.insert(pendingUploads.end(), decodedTextures.begin(), decodedTextures.end());
+	decodedTextures.clear();
+	decodedTextureMtx.unlock();
+
 	loadingMtx.lock();
+	//new requests: apply if loaded, wait if already decoding, otherwise start decoding
 	for (size_t i = 0; i < texturesToLoad.size(); i++) {
 		TexturedObjectToLoad& toLoad = texturesToLoad[i];
-		sf::Texture* texture = new sf::Texture();
-		if (!texture->loadFromFile(toLoad.path)) {
-			std::cout << "failed to load texture of path '" << toLoad.path << "'";
-			loadingMtx.unlock();
-			return;
+		std::string key = textureKey(toLoad.path, toLoad.repeat);
+		auto loaded = loadedTextures.find(key);
+		if (loaded != loadedTextures.end()) {
+			toLoad.setTexture(loaded->second);
+			toLoad.owner->changedSinceSnapshot.store(true);
+			continue;
 		}
-		if (toLoad.repeat == true) {
-			sf::Image img = texture->copyToImage();
-			if (texture->loadFromImage(img) == false) {
-				std::cout << "failed to load texture image of path '" << toLoad.path << "'";
-				loadingMtx.unlock();
-				return;
+		auto decoding = texturesInDecoding.find(key);
+		if (decoding != texturesInDecoding.end()) {
+			decoding->second.push_back(toLoad);
+			continue;
+		}
+		texturesInDecoding[key].push_back(toLoad);
+		std::string path = toLoad.path;
+		bool repeat = toLoad.repeat;
+		std::function<void()> decode = [key, path, repeat]() {
+			sf::Image* image = new sf::Image();
+			if (image->loadFromFile(path) == false) {
+				delete image;
+				image = nullptr;
 			}
-			texture->setRepeated(true);
+			decodedTextureMtx.lock();
+			decodedTextures.push_back(DecodedTexture{ key, path, repeat, image });
+			decodedTextureMtx.unlock();
+			requestRedraw();
+		};
+		if (headless == true || loadingPool == nullptr) {//headless: decode right away, so that the texture is in this frame no matter how fast the disk is
+			decode();
 		}
-		//TODO: We dont actually need mutices here to tell the main thread that the texture changed, because the texture is only used in this thread. Add them anyway for safety.
-		loadedTextures[toLoad.path] = texture;//was already added to map so that the pointer could be returned
-		toLoad.setTexture(loadedTextures[toLoad.path]);
-		texturesToLoad.erase(texturesToLoad.begin() + i);
+		else {
+			loadingPool->enqueue(decode);
+		}
+	}
+	texturesToLoad.clear();
+	if (headless == true) {
+		decodedTextureMtx.lock();
+		pendingUploads.insert(pendingUploads.end(), decodedTextures.begin(), decodedTextures.end());
+		decodedTextures.clear();
+		decodedTextureMtx.unlock();
 	}
+
+	uploadPendingTextures();
 	loadingMtx.unlock();
+}
+
+void Renderer::uploadPendingTextures() {
+	if (pendingUploads.empty() == true) {
+		return;
+	}
+	PROFILE_SCOPE("uploadPendingTextures");
+	//textures that are waited for by shown drawables first, otherwise keep the order in which they finished decoding
+	auto isWaitedForByShown = [](const DecodedTexture& decoded) {
+		std::vector<TexturedObjectToLoad>& waiting = texturesInDecoding[decoded.key];
+		for (size_t i = 0; i < waiting.size(); i++) {
+			if (waiting[i].owner->isShown() == true) {
+				return true;
+			}
+		}
+		return false;
+	};
+	std::stable_partition(pendingUploads.begin(), pendingUploads.end(), isWaitedForByShown);
+
+	sf::Clock clock;
+	int64_t timeBudget = uploadBudgetMicroseconds.load();
+	size_t byteBudget = uploadBudgetBytes.load();
+	if (headless == true) {//a time budget would make the frame in which a texture shows up depend on the machine
+		timeBudget = INT64_MAX;
+		byteBudget = SIZE_MAX;
+	}
+	size_t uploadedBytes = 0;
+	size_t uploaded = 0;
+	for (; uploaded < pendingUploads.size(); uploaded++) {
+		DecodedTexture& decoded = pendingUploads[uploaded];
+		size_t bytes = decoded.image != nullptr ? (size_t)decoded.image->getSize().x * decoded.image->getSize().y * 4 : 0;
+		if (uploaded > 0 && (clock.getElapsedTime().asMicroseconds() >= timeBudget || uploadedBytes + bytes > byteBudget)) {
+			break;//rest goes into the next frame
+		}
+		uploadedBytes += bytes;
+
+		//apply to every shape that waited for it
+		LoadedTexture texture;
+		if (uploadTexture(decoded, texture) == true) {
+			if (backend != nullptr) {
+				backend->onTextureLoaded(texture.texture, texture.rect, *decoded.image);
+			}
+			loadedTextures[decoded.key] = texture;
+			std::vector<TexturedObjectToLoad>& waiting = texturesInDecoding[decoded.key];
+			for (size_t j = 0; j < waiting.size(); j++) {
+				waiting[j].setTexture(texture);
+				waiting[j].owner->changedSinceSnapshot.store(true);
+			}
+		}
+		//on failure the waiting shapes stay untextured, a later request of the same file tries again
+		texturesInDecoding.erase(decoded.key);
+		delete decoded.image;
+	}
+	pendingUploads.erase(pendingUploads.begin(), pendingUploads.begin() + uploaded);
+	if (pendingUploads.empty() == false) {
+		requestRedraw();//continue in the next frame
+	}
+}
+
+bool Renderer::uploadTexture(DecodedTexture& decoded, LoadedTexture& out) {
+	if (decoded.image == nullptr) {
+		std::cout << "failed to load texture of path '" << decoded.path << "'\n";
+		return false;
+	}
+	//repeated textures have to wrap around at their own edges, so they can't share a page
+	if (decoded.repeat == false && atlasEnabled.load() == true && atlas.insert(*decoded.image, out) == true) {
+		return true;
+	}
+	out.texture = new sf::Texture();
+	if (out.texture->loadFromImage(*decoded.image) == false) {
+		std::cout << "failed to load texture image of path '" << decoded.path << "'\n";
+		delete out.texture;
+		out.texture = nullptr;
+		return false;
+	}
+	out.texture->setRepeated(decoded.repeat);
+	out.rect = sf::IntRect(0, 0, (int)decoded.image->getSize().x, (int)decoded.image->getSize().y);
+	return true;
 }
\ No newline at end of file
@@ -2,58 +2,208 @@
 #include "ThreadSafeObjects.hpp"
 #include "SleepAPI.hpp"
 #include "Mouse.hpp"
+#include "MPSCQueue.hpp"
+#include "ShapeBatcher.hpp"
+#include "TextureAtlas.hpp"
+#include "ThreadPool.hpp"
+#include "TickScheduler.hpp"
+#include "Tween.hpp"
+#include "Kinematics.hpp"
+#include "RenderBackend.hpp"
+#include "Profiler.hpp"
+#include "Camera.hpp"
+#include "SpatialGrid.hpp"
 
 #include <iostream>
 #include <vector>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <unordered_set>
+#include <unordered_map>
+#include <algorithm>
 #include "SFML/Graphics.hpp"
 
 
 struct TexturedObjectToLoad {
 public:
-	TexturedObjectToLoad(std::string path, bool repeat, sf::Shape* toApply) : path(path), repeat(repeat), toApply(toApply) {}
+	TexturedObjectToLoad(std::string path, bool repeat, sf::Shape* toApply, ts::Drawable* owner) : path(path), repeat(repeat), toApply(toApply), owner(owner) {}
 	std::string path;
 	bool repeat;
 	sf::Shape* toApply;
+	ts::Drawable* owner;//the ts object that wraps "toApply"
 
-	void setTexture(sf::Texture* texture) {
-		toApply->setTexture(texture);
+	void setTexture(const LoadedTexture& loaded) {
+		toApply->setTexture(loaded.texture, true);
+		toApply->setTextureRect(loaded.rect);//only differs from the full texture for atlas regions
 	}
+};
 
-	void setPriority(int priority) {
-		this->priority = priority;
-	}
-	int getPriority() {
-		return priority;
-	}
-	void makeBackground() {
-		priority = 0;
-	}
-private:
-	int priority = 1;//0 := lowest priority (backgrounds etc)
+//Result of decoding a texture file on a loading thread. "image" is nullptr if the file could not be loaded.
+struct DecodedTexture {
+	std::string key;
+	std::string path;
+	bool repeat;
+	sf::Image* image;
+};
+
+//Entry of the change queue. The serial is copied so that entries of deleted drawables can be recognized without dereferencing them.
+struct ChangedObject {
+	ts::Drawable* object = nullptr;
+	uint64_t serial = 0;
+};
+
+//Front buffer of one drawable in the scene snapshot. "shape" is set if it can be batched with other shapes.
+struct SnapshotEntry {
+	sf::Drawable* drawable;
+	sf::Shape* shape;
+	sf::FloatRect bounds;
+};
+
+//All drawables of one layer in drawing order. Every drawable knows its slot in here.
+//Removing one leaves a nullptr in its slot (O(1)), compact() closes the gaps while keeping the drawing order.
+struct DrawLayer {
+	std::vector<ts::Drawable*> objects;
+	size_t removed = 0;
+
+	void add(ts::Drawable* object);
+	void remove(ts::Drawable* object);
+	void compact();
 };
 
 class Renderer {
 private:
-	//Threadsafe objects that are cummulatively locked, drawn and individually unlocked each frame
-	static std::vector<ts::Drawable*> permanentObjects;
-	static std::mutex permanentObjectMtx;
-	static std::vector<ts::Drawable*> changedObjects;
-	static std::mutex changedObjectMtx;
-	static std::mutex drawingMtx;
+	//Threadsafe objects that are cummulatively locked, copied into their front buffers and individually unlocked each frame.
+	//Layers are drawn from the lowest to the highest key, so changing the layer of one drawable only touches two buckets.
+	static std::map<int, DrawLayer> permanentObjects;
+	static ProfiledMutex permanentObjectMtx;
+
+	//Drawables with changes that have to be applied in the rendering thread. Any thread can push, only the rendering thread drains.
+	static MPSCQueue<ChangedObject, 65536> changedObjects;
+	//Set when a push failed because the queue was full. The affected drawables keep their queued flag and are found by a sweep over all objects.
+	static std::atomic<bool> changedObjectsOverflowed;
+	//Serials of drawables that were deleted while queued, with the enqueue position of changedObjects at that time. Guarded by permanentObjectMtx.
+	//An entry is removed once the queue was drained past that position, a slot that was claimed but not yet written can hold up the drain.
+	static std::unordered_map<uint64_t, size_t> droppedChanges;
+	//Animations of shapes, evaluated while taking the snapshot
+	static TweenEngine tweenEngine;
+	//Serials of deleted drawables that had tweens, with the command position of the tween engine at that time. Guarded by permanentObjectMtx.
+	//An entry is removed once the engine executed all commands before that position, so no queued tween can target the freed drawable.
+	static std::unordered_map<uint64_t, size_t> droppedTweenTargets;
+	//Moving drawables, integrated while taking the snapshot. Lock kinematicsMtx after permanentObjectMtx and the drawables, never before.
+	static KinematicSystem kinematics;
+	static ProfiledMutex kinematicsMtx;
+	static ProfiledMutex drawingMtx;
 	static std::thread* renderingThread;
 
+	//Front buffers of all shown drawables at the last frame boundary that are inside of the camera's view, in drawing order. Only touched by the rendering thread.
+	static std::vector<SnapshotEntry> sceneSnapshot;
+	static ShapeBatcher batcher;
+	static std::atomic<bool> batchingEnabled;
+	static std::atomic<unsigned int> lastFrameDrawCalls;
+	//Front buffers of deleted drawables. They can still be part of sceneSnapshot, so they are deleted when the next snapshot is taken.
+	static std::vector<sf::Drawable*> retiredFrontBuffers;
+	static ProfiledMutex retiredFrontBufferMtx;
+
+	//On-demand redrawing: the rendering thread sleeps until something requests a redraw (or the idle interval passed)
+	static std::atomic<bool> onDemandRedraw;
+	static std::atomic<bool> redrawRequested;
+	static std::atomic<int64_t> idleRedrawMicroseconds;
+	static std::mutex redrawMtx;
+	static std::condition_variable redrawCondition;
+	static void waitForRedrawRequest();
+
+	//Dirty rectangle redrawing: the scene is kept in "sceneBuffer" and only the part that changed is redrawn into it
+	static std::atomic<bool> dirtyRectRedraw;
+	static std::atomic<float> fullRedrawThreshold;
+	static sf::RenderTexture* sceneBuffer;
+	//Old and new bounds of everything that changed, was added or removed since the last snapshot, in world coordinates. Guarded by permanentObjectMtx.
+	static std::vector<sf::FloatRect> dirtyAreas;
+	//dirtyAreas of the frame that is drawn in window pixels, passed to the backend (see RenderBackend::markDirty), and their union. Only touched by the rendering thread.
+	static std::vector<sf::FloatRect> frameDirtyAreas;
+	static sf::FloatRect frameDirtyRegion;
+	/* Only call with permanentObjectMtx locked. */
+	static void addDirtyRegion(const sf::FloatRect& bounds);
+	/* Only call with permanentObjectMtx locked, after updateFrameCamera. Moves dirtyAreas into frameDirtyAreas and frameDirtyRegion. */
+	static void takeFrameDirtyAreas();
+	/* Redraws the dirty part of sceneBuffer (or all of it) and presents it in the window. */
+	static void drawDirtyRegion();
+	/* Draws the snapshot entries that intersect "clip" (in world coordinates, all if it is nullptr) with the view that is set on "target". */
+	static void drawSnapshot(sf::RenderTarget* target, const sf::FloatRect* clip);
+
+	//Schedules the callback of startEventloop
+	static TickScheduler tickScheduler;
+	//Number of finished callbacks and when the last one finished (steady clock microseconds), for render interpolation
+	static std::atomic<uint64_t> completedTicks;
+	static std::atomic<int64_t> lastTickMicroseconds;
+	static std::atomic<bool> interpolationEnabled;
+	/* How far the time has progressed from the last completed tick towards the next one, 0-1. */
+	static float getTickAlpha();
+	/* Handles window events until "deadline". Returns early if the window was closed. */
+	static void handleEventsUntil(TickScheduler::Clock::time_point deadline);
+	//for way more accurate sleeps than this_thread::sleep allows. One per thread, so that their statistics stay apart.
+	static SleepAPI eventloopSleeper;
+	static SleepAPI frameSleeper;
+	//Minimum time between the start of two frames in microseconds, 0 = unlimited
+	static std::atomic<int64_t> frameIntervalMicroseconds;
+
 	static void threadInit();
 	static void loop();
+	/* Applies all queued changes and copies every changed drawable into its front buffer. This is the only part of a frame that locks the drawables. */
+	static void takeSceneSnapshot();
+
+	//Culling: shown drawables are kept in a uniform grid by their snapshot bounds, the snapshot only takes the ones the grid finds in the camera's view.
+	//The grid is only updated for drawables that changed, so static drawables outside of the view cost nothing when drawing.
+	static ts::Camera camera;
+	static SpatialGrid<ts::Drawable*> cullingGrid;
+	static std::atomic<bool> cullingEnabled;
+	static std::atomic<unsigned int> lastFrameVisibleObjects;
+	//Drawables found in the view, sorted into drawing order. Only touched by the rendering thread.
+	static std::vector<ts::Drawable*> visibleObjects;
+	//Camera state of the frame that is drawn. Only touched by the rendering thread.
+	static uint64_t frameCameraVersion;
+	static bool frameCameraChanged;
+	static sf::View frameView;
+	static sf::FloatRect frameWorldBounds;
+	//World coordinates to window pixels, dirty areas are collected in world coordinates and mapped with this
+	static sf::Transform frameViewToPixels;
+	/* Reads the camera at the start of a frame */
+	static void updateFrameCamera();
+	/* Only call with permanentObjectMtx locked. Fills sceneSnapshot with the shown drawables in the view. */
+	static void collectVisibleObjects();
 
 	//SFML always uses the dimensions of window creation, which means we only have to save these once in the constructor.
 	static int xPixels, yPixels;
+	static sf::ContextSettings contextSettings;
+
+	//Headless mode: frames go into offscreenTarget and are only drawn by stepFrame
+	static bool headless;
+	static sf::RenderTexture* offscreenTarget;
+	/* Seconds since the first frame, advanced by the real time or by stepFrame in headless mode. Tweens and motion run on this clock. Only used by the rendering thread. */
+	static double frameClock;
+	static std::chrono::steady_clock::time_point frameClockStart;
+
+	/* The window or the offscreen target */
+	static sf::RenderTarget* getRenderTarget();
+	static void presentFrame();
+
+	//Draws the snapshot instead of the SFML pipeline if set
+	static RenderBackend* backend;
+	//Shows frames of backends that draw into memory in the window, only the rects that changed are uploaded
+	static sf::Texture* backendPresentTexture;
+	static std::vector<sf::IntRect> backendChangedRects;
+	static std::vector<sf::Uint8> backendUploadBuffer;
+	static void uploadBackendFrame(const sf::Uint8* framebuffer, sf::Vector2u size);
+	static void drawWithBackend();
 public:
+	//nullptr in headless mode
 	static sf::RenderWindow* window;
 	/** Creates a window and starts a seperate drawing thread.
 	*/
 
+	/* Prevents the renderer from taking a new snapshot of the scene until continueDrawing() is called. The last snapshot is still drawn,
+	* so all changes made in between show up together.*/
 	static void stopDrawing() {
 		drawingMtx.lock();
 	}
@@ -63,95 +213,341 @@ public:
 	}
 
 	static void initSettings() {
-		sf::ContextSettings settings;
-		settings.antialiasingLevel = 8;
-		window = new sf::RenderWindow(sf::VideoMode(1920, 1080), "Rendering!", sf::Style::Titlebar | sf::Style::Close | sf::Style::Resize, settings);
+		contextSettings.antialiasingLevel = 8;
+		window = new sf::RenderWindow(sf::VideoMode(1920, 1080), "Rendering!", sf::Style::Titlebar | sf::Style::Close | sf::Style::Resize, contextSettings);
 		window->setActive(false);
 		xPixels = window->getSize().x;
 		yPixels = window->getSize().y;
-		window->setFramerateLimit(60);
+		camera.reset(sf::Vector2f((float)xPixels, (float)yPixels));
 	}
 public:
 
 	static void init() {
 		initSettings();
+		//decoding is mostly file reading and inflating, so a few threads are enough and leave the rest of the cores to the game
+		loadingPool = new ThreadPool(std::max(1u, std::thread::hardware_concurrency() / 2));
+	}
+
+	/** Call instead of init() to render into an offscreen texture of "width" x "height" without a window and without a rendering thread.
+	* Frames are only drawn by stepFrame(), so benchmarks and tests can drive the same frame pipeline one frame at a time. Don't call startEventloop in this mode.
+	* With a "backend" (e.g. a SoftwareRasterizer of the same size), frames are drawn by it and no offscreen texture is created.*/
+	static void initHeadless(unsigned int width = 1920, unsigned int height = 1080, RenderBackend* backend = nullptr) {
+		headless = true;
+		camera.reset(sf::Vector2f((float)width, (float)height));
+		contextSettings.antialiasingLevel = 8;
+		if (backend != nullptr) {
+			Renderer::backend = backend;
+		}
+		else {
+			offscreenTarget = new sf::RenderTexture();
+			offscreenTarget->create(width, height, contextSettings);
+		}
+		xPixels = (int)width;
+		yPixels = (int)height;
+		//no loadingPool, textures are decoded in stepFrame
+	}
+
+	/** Headless only: draws exactly one frame in the calling thread. Tweens and motion advance by "frameTime" instead of the real time
+	* and all requested textures are loaded within the frame, so the same sequence of calls always produces the same frames.*/
+	static void stepFrame(sf::Time frameTime = sf::seconds(1.0f / 60.0f));
+
+	/* Headless only: the last frame drawn by stepFrame */
+	static sf::Image captureFrame() {
+		if (backend != nullptr && backend->getFramebuffer() != nullptr) {
+			sf::Image image;
+			image.create(backend->getSize().x, backend->getSize().y, backend->getFramebuffer());
+			return image;
+		}
+		return offscreenTarget->getTexture().copyToImage();
 	}
 
+	/** Draws every frame with "backend" instead of SFML (nullptr switches back). The Renderer doesn't take ownership.
+	* Call it before the first frame and before textures are loaded, backends may need to see every loaded texture (see RenderBackend::onTextureLoaded).
+	* Backends are told what changed in every frame (see RenderBackend::markDirty), setDirtyRectRedraw and batching only apply to the SFML pipeline.*/
+	static void setRenderBackend(RenderBackend* backend) {
+		drawingMtx.lock();
+		if (backend != nullptr) {//it didn't see the changes while it wasn't used
+			backend->markAllDirty();
+		}
+		Renderer::backend = backend;
+		drawingMtx.unlock();
+		requestRedraw();
+	}
+
+	static bool isHeadless() {
+		return headless;
+	}
+
+	/* Calls "callbackEventloop" at a fixed rate (see setTickRate) in the calling thread until the window is closed. Between ticks, window events are handled as they arrive.
+	* If a callback takes too long, the missed ticks are caught up back to back (up to a limit), so the game time stays in sync with the real time.*/
 	static void startEventloop(void (*callbackEventloop)()) {
 		renderingThread = new std::thread(&Renderer::threadInit);
+		PROFILE_THREAD("Game");
 
-		SleepAPI sleepAPI{};//for way more accurate sleeps than this_thread::sleep allows
-		sf::Event eventCatcher{};
+		tickScheduler.start();
 		//Event loop of main thread main thread
 		while (window->isOpen()) {
-			sleepAPI.millisleep(16);
-			while (Renderer::window->pollEvent(eventCatcher)) {
-				if (eventCatcher.type == sf::Event::Closed) {
-					Renderer::window->close();
-					break;
-				}
+			handleEventsUntil(tickScheduler.getNextDeadline());
+			unsigned int dueTicks = tickScheduler.takeDueTicks();
+			for (unsigned int i = 0; i < dueTicks && window->isOpen(); i++) {
+				PROFILE_SCOPE("tick");
+				auto started = TickScheduler::Clock::now();
+				PROFILE_PHASE(callbackPhase, "callbackEventloop");
+				callbackEventloop();
+				PROFILE_END(callbackPhase);
+				Mouse::update();
+				auto finished = TickScheduler::Clock::now();
+				tickScheduler.recordTick(started, finished);
+				lastTickMicroseconds.store(std::chrono::duration_cast<std::chrono::microseconds>(finished.time_since_epoch()).count());
+				completedTicks.fetch_add(1);
 			}
-			callbackEventloop();
-			Mouse::update();
 		}
+		requestRedraw();//wake up the rendering thread so that it notices the closed window
 		Renderer::joinDrawingThread();//when finished, join the drawing thread before exiting
+		//the decode workers lock static mutexes, they have to be finished before static destruction starts
+		delete loadingPool;
+		loadingPool = nullptr;
+	}
+
+	/* Sets how often the callback of startEventloop is called and how many missed ticks are caught up at once at most. Default is 60 per second and 5. */
+	static void setTickRate(double ticksPerSecond, unsigned int maxCatchUpTicks = 5) {
+		tickScheduler.setTickRate(ticksPerSecond, maxCatchUpTicks);
+	}
+
+	/* Number of ticks, overruns (callback took longer than a tick), dropped ticks and timings of the event loop. Can be called from any thread. */
+	static TickStatistics getTickStatistics() {
+		return tickScheduler.getStatistics();
+	}
+
+	/* If enabled, shapes are drawn between the position, size and radius of the last two ticks of the event loop, by how much of the current tick has passed.
+	* Motion stays smooth when the rendering thread draws more frames than there are ticks, at the cost of showing the game state one tick late. Off by default, ignored in headless mode.*/
+	static void setInterpolation(bool enabled) {
+		interpolationEnabled.store(enabled);
+		requestRedraw();
+	}
+
+	static uint64_t getCompletedTicks() {
+		return completedTicks.load();
+	}
+
+	/* Limits how many frames the rendering thread draws per second (0 = unlimited). Default is 60.
+	* Uses the precise deadline based sleeps of SleepAPI instead of sf::Window::setFramerateLimit, which jitters by milliseconds.*/
+	static void setFramerateLimit(unsigned int framesPerSecond) {
+		frameIntervalMicroseconds.store(framesPerSecond > 0 ? 1000000 / framesPerSecond : 0);
+	}
+
+	/* How precisely the event loop woke up for its ticks. Can be called from any thread. */
+	static SleepStatistics getEventloopSleepStatistics() {
+		return eventloopSleeper.getStatistics();
+	}
+
+	/* How precisely the rendering thread woke up for its frames. Can be called from any thread. */
+	static SleepStatistics getFrameLimiterStatistics() {
+		return frameSleeper.getStatistics();
+	}
+
+	/* In on-demand mode the rendering thread only draws a frame if something changed: a drawable was changed, added or removed, a texture finished loading
+	* or the window received an event. When nothing happens, it still redraws once per "idleRedrawInterval" (never if it is sf::Time::Zero).
+	* Off by default, then every frame is drawn at the framerate limit.*/
+	static void setOnDemandRedraw(bool enabled, sf::Time idleRedrawInterval = sf::seconds(1.0f)) {
+		idleRedrawMicroseconds.store(idleRedrawInterval.asMicroseconds());
+		onDemandRedraw.store(enabled);
+		requestRedraw();
+	}
+
+	/* Wakes up the rendering thread in on-demand mode. Cheap if a redraw is already requested, so it can be called for every change. */
+	static void requestRedraw() {
+		if (redrawRequested.load(std::memory_order_relaxed) == true) {//keeps the common case free of writes to a shared cache line
+			return;
+		}
+		if (redrawRequested.exchange(true) == false) {
+			//taking the mutex makes sure that the rendering thread is either before its check of the flag or already waiting
+			redrawMtx.lock();
+			redrawMtx.unlock();
+			redrawCondition.notify_one();
+		}
 	}
 
 	static void addBackground(std::string texturePath, bool repeat) {
-		ts::Rect* background = (new ts::Rect(0, 0, (float)xPixels, (float)yPixels))->addTexture(texturePath, repeat);//0 is lowest priority => drawn in the back.
-		removePermanentObject(background);//it was added at the end of the line, but we want it to be drawn first.
-		permanentObjects.insert(permanentObjects.begin(), background);//reinsert at front
+		(new ts::Rect(0, 0, (float)xPixels, (float)yPixels))->addTexture(texturePath, repeat)->setLayer(ts::Drawable::backgroundLayer);//drawn behind everything on the default layer
 	}
 
 	//Drawing--------------------------------------------------------------------------------------------------------------------------------------
 
 	static void addPermanentObject(ts::Drawable* object) {
-		permanentObjectMtx.lock();//dont add objects while drawing. 
-		permanentObjects.push_back(object);
+		permanentObjectMtx.lock();//dont add objects while taking a snapshot.
+		permanentObjects[object->layer].add(object);
+		permanentObjectMtx.unlock();
+		requestRedraw();
+	}
+
+	/* Moves "object" to the end of the drawing order of "layer". Does nothing if it is already on that layer. */
+	static void changeLayer(ts::Drawable* object, int layer) {
+		permanentObjectMtx.lock();
+		if (object->layer != layer) {
+			if (object->registrySlot == -1) {//not registered (anymore), just remember the layer
+				object->layer = layer;
+			}
+			else {
+				permanentObjects[object->layer].remove(object);
+				object->layer = layer;
+				permanentObjects[layer].add(object);
+			}
+			object->changedSinceSnapshot.store(true);//draws over or under other drawables now
+		}
+		permanentObjectMtx.unlock();
+		requestRedraw();
+	}
+
+	static int getLayer(ts::Drawable* object) {
+		permanentObjectMtx.lock();
+		int layer = object->layer;
 		permanentObjectMtx.unlock();
+		return layer;
 	}
 
+	//Never blocks. Only call once per queued change of "object" (see Drawable::prepareApplyingChanges).
 	static void addAsChangedObject(ts::Drawable* object) {
-		changedObjectMtx.lock();
-		changedObjects.push_back(object);
-		changedObjectMtx.unlock();
+		if (changedObjects.tryPush(ChangedObject{ object, object->getSerial() }) == false) {
+			changedObjectsOverflowed.store(true, std::memory_order_release);
+		}
 	}
 
 	/*Call this in the destructor of an Object and it will remove itself from the drawing array when deleted.*/
 
 	static void removePermanentObject(ts::Drawable* object) {
 		permanentObjectMtx.lock();
-
-		for (int i = permanentObjects.size() - 1; i >= 0; i--) {//search from the back because those objects are more probable to be temporary
-			if (permanentObjects[i] == object) {
-				auto a = permanentObjects[permanentObjects.size() - 1];
-				auto b = permanentObjects[permanentObjects.size() - 2];
-				auto c = permanentObjects[permanentObjects.size() - 3];
-				auto d = permanentObjects[permanentObjects.size() - 4];
-				permanentObjects.erase(permanentObjects.begin() + i);
-
-				auto e = permanentObjects[permanentObjects.size() - 1];
-				auto f = permanentObjects[permanentObjects.size() - 2];
-				auto g = permanentObjects[permanentObjects.size() - 3];
-				auto h = permanentObjects[permanentObjects.size() - 4];
-				break;
-			}
+		if (object->registrySlot == -1) {//already removed
+			permanentObjectMtx.unlock();
+			return;
 		}
-		permanentObjectMtx.unlock();
-		//can also be in changed objects, remove it from there as well.
-		changedObjectMtx.lock();
-		for (int i = changedObjects.size() - 1; i >= 0; i--) {
-			if (changedObjects[i] == object) {
-				changedObjects.erase(changedObjects.begin() + i);
-				break;
-			}
+		permanentObjects[object->layer].remove(object);
+		if (object->snapshotShown == true) {//the area it covered has to be redrawn without it
+			addDirtyRegion(object->snapshotBounds);
 		}
-		changedObjectMtx.unlock();
+		cullingGrid.remove(object, object->cullingCells);
+		object->cullingCells = GridCellRange();
+		//can also be in changed objects, the rendering thread skips it there.
+		if (object->isQueuedForChanges() == true) {
+			droppedChanges[object->getSerial()] = changedObjects.getEnqueuePosition();
+		}
+		if (object->hasTweens.load() == true) {
+			droppedTweenTargets[object->getSerial()] = tweenEngine.getCommandPosition();
+		}
+		permanentObjectMtx.unlock();
+		requestRedraw();
+	}
+
+	/* Call this in the destructor of a Drawable with its front buffer. Ownership is passed to the Renderer.*/
+	static void retireFrontBuffer(sf::Drawable* frontBuffer) {
+		retiredFrontBufferMtx.lock();
+		retiredFrontBuffers.push_back(frontBuffer);
+		retiredFrontBufferMtx.unlock();
 	}
 
 	static void drawFrame();
 	static void joinDrawingThread();
 
+	/* See ts::Drawable::setMotion */
+	static void setMotion(ts::Drawable* object, sf::Vector2f velocity, sf::Vector2f acceleration, float angularVelocity) {
+		sf::Vector2f position;
+		float rotation;
+		object->readTransform(position, rotation);
+		kinematicsMtx.lock();
+		if (object->kinematicSlot == -1) {//starts where the game thread put it
+			object->kinematicSlot = kinematics.add(object, position, rotation);
+		}
+		kinematics.setMotion(object->kinematicSlot, velocity, acceleration, angularVelocity);
+		kinematicsMtx.unlock();
+		requestRedraw();
+	}
+
+	/* Call this in the destructor of a Drawable with "writeBack" = false. */
+	static void stopMotion(ts::Drawable* object, bool writeBack) {
+		kinematicsMtx.lock();
+		if (object->kinematicSlot == -1) {
+			kinematicsMtx.unlock();
+			return;
+		}
+		ts::MotionState state = kinematics.getState(object->kinematicSlot);
+		ts::Drawable* moved = kinematics.remove(object->kinematicSlot);
+		if (moved != nullptr) {
+			moved->kinematicSlot = object->kinematicSlot;
+		}
+		object->kinematicSlot = -1;
+		kinematicsMtx.unlock();
+		if (writeBack == true) {
+			object->writeTransform(state.position, state.rotation);
+		}
+	}
+
+	/* See ts::Drawable::syncMotion */
+	static ts::MotionState syncMotion(ts::Drawable* object) {
+		ts::MotionState state;
+		kinematicsMtx.lock();
+		if (object->kinematicSlot == -1) {//not moving, the drawable already knows where it is
+			kinematicsMtx.unlock();
+			object->readTransform(state.position, state.rotation);
+			return state;
+		}
+		state = kinematics.getState(object->kinematicSlot);
+		kinematicsMtx.unlock();
+		object->writeTransform(state.position, state.rotation);
+		return state;
+	}
+
+	/** Starts animating the target of "tween" in the rendering thread and returns the id of the tween. Never blocks.
+	* Tweens of a deleted shape are dropped. If several tweens animate the same property at once, the one added last wins.*/
+	static uint64_t addTween(const ts::Tween& tween) {
+		tween.target->hasTweens.store(true);
+		uint64_t id = tweenEngine.add(tween, tween.target->getSerial());
+		requestRedraw();
+		return id;
+	}
+
+	/* Stops the tween where it is, together with all tweens chained after it. */
+	static void cancelTween(uint64_t tweenId) {
+		tweenEngine.cancel(tweenId);
+		requestRedraw();
+	}
+
+	static size_t getActiveTweenCount() {
+		return tweenEngine.getActiveCount();
+	}
+
+	/* Consecutive shapes with the same texture are merged into one draw call (on by default). Disabling it draws every object on its own. */
+	static void setBatchingEnabled(bool enabled) {
+		batchingEnabled.store(enabled);
+	}
+
+	static unsigned int getLastFrameDrawCalls() {
+		return lastFrameDrawCalls.load();
+	}
+
+	/* The camera that decides which part of the world is shown (see ts::Camera). Can be changed from any thread. */
+	static ts::Camera& getCamera() {
+		return camera;
+	}
+
+	/* Drawables outside of the camera's view are skipped before drawing, found in bulk through a uniform grid over their bounds. On by default. */
+	static void setCullingEnabled(bool enabled) {
+		cullingEnabled.store(enabled);
+		requestRedraw();
+	}
+
+	/* Shown drawables that were inside of the view in the last frame (all shown drawables if culling is disabled) */
+	static unsigned int getLastFrameVisibleObjects() {
+		return lastFrameVisibleObjects.load();
+	}
+
+	/* If enabled, the scene is kept in an offscreen buffer and only the union of the areas that changed since the last frame is redrawn into it.
+	* If that union covers more than "fullRedrawThreshold" of the window (0-1), everything is redrawn. Off by default.*/
+	static void setDirtyRectRedraw(bool enabled, float fullRedrawThreshold = 0.5f) {
+		Renderer::fullRedrawThreshold.store(fullRedrawThreshold);
+		dirtyRectRedraw.store(enabled);
+		requestRedraw();
+	}
+
 	//Utility-----------------------------------------------------------------------------------------------------------------------------------------
 
 	//Width of the window panel, can't be asked directly from the window
@@ -164,36 +560,86 @@ public:
 	}
 
 	//Texture loading---------------------------------------------------------------------------------------------------------------------------------
-	//(This has to be done in Rendering thread because the window has to be activated. Also, doing this here relieves a lot of load from the main thread)
+	//Files are read and decoded into sf::Images on the loading pool. Only the upload to the GPU is done in the Rendering thread, because the window has to be activated.
 private:
-	static std::map<std::string, sf::Texture*> loadedTextures;
+	//Keyed by textureKey(), because the same file can be needed once repeated (standalone) and once packed into the atlas. Only written by the rendering thread.
+	static std::map<std::string, LoadedTexture> loadedTextures;
+	//Requests of the game thread that were not looked at by the rendering thread yet
 	static std::vector<TexturedObjectToLoad> texturesToLoad;
-	static std::mutex loadingMtx;
+	//Requests whose file is currently decoded, by key. Several shapes can wait for the same file.
+	static std::map<std::string, std::vector<TexturedObjectToLoad>> texturesInDecoding;
+	static ProfiledMutex loadingMtx;
+	//Filled by the loading pool, emptied by the rendering thread
+	static std::vector<DecodedTexture> decodedTextures;
+	static ProfiledMutex decodedTextureMtx;
+	//Decodes textures in the background, nullptr in headless mode
+	static ThreadPool* loadingPool;
+	static TextureAtlas atlas;
+	static std::atomic<bool> atlasEnabled;
+
+	//Decoded images that did not fit into the upload budget of their frame. Only touched by the rendering thread.
+	static std::vector<DecodedTexture> pendingUploads;
+	static std::atomic<int64_t> uploadBudgetMicroseconds;
+	static std::atomic<size_t> uploadBudgetBytes;
 
-	/* Call before drawing! Loads all the textures in "texturesToLoad" by filling the empty Texture pointers in "loadedTextures" and removing the entry from "texturesToLoad"*/
+	/* Call before drawing! Applies already loaded textures, starts decoding new files and uploads decoded files within the upload budget.
+	* Never waits for a file. */
 	static void loadAllTextures();
+	/* Uploads pending textures until the budget of this frame is used up. Textures that shown drawables wait for go first. Call with loadingMtx locked. */
+	static void uploadPendingTextures();
+	/* Creates the GPU texture (standalone or in the atlas) for a decoded image. Returns false if that failed. */
+	static bool uploadTexture(DecodedTexture& decoded, LoadedTexture& out);
+
+	static std::string textureKey(const std::string& fullPath, bool repeat) {
+		return repeat == true ? fullPath + "?repeat" : fullPath;
+	}
 
 public:
 	/** @brief !Starting directory is Rendering/recources!
-	* Loads the texture in the Rendering Thread before the next drawing operation. Until it is loaded, returns a pointer to an empty texture.*/
-	static void queueTextureLoading(std::string path, bool repeat, sf::Shape* toApply) {
+	* Loads the texture in the background and applies it in the Rendering Thread once it is ready. Until then, the shape is drawn without a texture.
+	* Small textures that are not repeated are packed into a shared atlas page (see setTextureAtlasEnabled).*/
+	static void queueTextureLoading(std::string path, bool repeat, sf::Shape* toApply, ts::Drawable* owner) {
 		std::string fullPath = "Rendering/recources/" + path;
-		if (loadedTextures.count(path) == 0) {
-			loadingMtx.lock();
-			texturesToLoad.push_back(TexturedObjectToLoad(fullPath, repeat, toApply));
-			loadingMtx.unlock();
+		loadingMtx.lock();
+		texturesToLoad.push_back(TexturedObjectToLoad(fullPath, repeat, toApply, owner));//if it is already loaded, the rendering thread just applies it
+		loadingMtx.unlock();
+	}
+
+	/* Limits how much time and how many bytes of pixel data the Rendering thread spends on uploading textures per frame.
+	* The rest is uploaded in the next frames. At least one texture is uploaded per frame, so that loading always progresses.*/
+	static void setTextureUploadBudget(sf::Time timePerFrame, size_t bytesPerFrame) {
+		uploadBudgetMicroseconds.store(timePerFrame.asMicroseconds());
+		uploadBudgetBytes.store(bytesPerFrame);
+	}
+
+	/* Call this in the destructor of a shape, so that a texture that finishes loading later isn't applied to it. */
+	static void cancelTextureLoading(sf::Drawable* shape) {
+		loadingMtx.lock();
+		auto isTarget = [shape](const TexturedObjectToLoad& toLoad) { return toLoad.toApply == shape; };
+		texturesToLoad.erase(std::remove_if(texturesToLoad.begin(), texturesToLoad.end(), isTarget), texturesToLoad.end());
+		for (auto& [key, waiting] : texturesInDecoding) {
+			waiting.erase(std::remove_if(waiting.begin(), waiting.end(), isTarget), waiting.end());
 		}
+		loadingMtx.unlock();
+	}
+
+	/* Textures that are loaded after this call are packed into atlas pages (if they are small and not repeated) or kept standalone. On by default. */
+	static void setTextureAtlasEnabled(bool enabled) {
+		atlasEnabled.store(enabled);
 	}
 
-	bool isTextureLoaded(std::string path) {
+	static bool isTextureLoaded(std::string path, bool repeat) {
 		loadingMtx.lock();
-		bool out = loadedTextures.count(path) > 0;
+		bool out = loadedTextures.count(textureKey("Rendering/recources/" + path, repeat)) > 0;
 		loadingMtx.unlock();
 		return out;
 	}
 
 	//only call when "isTextureLoaded" is true!
-	sf::Texture* getLoadedTexture(std::string path) {
-		return loadedTextures[path];
+	static LoadedTexture getLoadedTexture(std::string path, bool repeat) {
+		loadingMtx.lock();
+		LoadedTexture out = loadedTextures[textureKey("Rendering/recources/" + path, repeat)];
+		loadingMtx.unlock();
+		return out;
 	}
 };
\ No newline at end of file
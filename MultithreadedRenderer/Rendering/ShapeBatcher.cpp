@@ -0,0 +1,137 @@
+#include "ShapeBatcher.hpp"
+#include <cmath>
+#include <algorithm>
+
+void ShapeBatcher::begin(sf::RenderTarget* target) {
+	this->target = target;
+	vertices.clear();
+	batchTexture = nullptr;
+	drawCalls = 0;
+}
+
+void ShapeBatcher::end() {
+	flush();
+}
+
+void ShapeBatcher::flush() {
+	if (vertices.empty() == false) {
+		sf::RenderStates states;
+		states.texture = batchTexture;
+		target->draw(vertices.data(), vertices.size(), sf::Triangles, states);
+		vertices.clear();
+		drawCalls++;
+	}
+}
+
+void ShapeBatcher::useTexture(const sf::Texture* texture) {
+	if (texture != batchTexture) {
+		flush();
+		batchTexture = texture;
+	}
+}
+
+void ShapeBatcher::addUnbatchable(const sf::Drawable& drawable) {
+	flush();
+	target->draw(drawable);
+	drawCalls++;
+}
+
+void ShapeBatcher::addShape(const sf::Shape& shape) {
+	size_t count = shape.getPointCount();
+	if (count < 3) {//sf::Shape doesn't draw these either
+		return;
+	}
+	points.resize(count);
+	sf::Vector2f min = shape.getPoint(0), max = min;
+	for (size_t i = 0; i < count; i++) {
+		points[i] = shape.getPoint(i);
+		min.x = std::min(min.x, points[i].x); min.y = std::min(min.y, points[i].y);
+		max.x = std::max(max.x, points[i].x); max.y = std::max(max.y, points[i].y);
+	}
+	sf::FloatRect insideBounds(min.x, min.y, max.x - min.x, max.y - min.y);
+	sf::Vector2f center(insideBounds.left + insideBounds.width / 2, insideBounds.top + insideBounds.height / 2);
+	const sf::Transform& transform = shape.getTransform();
+
+	useTexture(shape.getTexture());
+	addFill(shape, transform, center, insideBounds);
+	if (shape.getOutlineThickness() != 0) {
+		useTexture(nullptr);//outlines are never textured
+		addOutline(shape, transform, center);
+	}
+}
+
+void ShapeBatcher::addFill(const sf::Shape& shape, const sf::Transform& transform, sf::Vector2f center, const sf::FloatRect& insideBounds) {
+	sf::Color color = shape.getFillColor();
+	const sf::IntRect& textureRect = shape.getTextureRect();
+	auto texCoords = [&](sf::Vector2f point) {
+		float xRatio = insideBounds.width > 0 ? (point.x - insideBounds.left) / insideBounds.width : 0;
+		float yRatio = insideBounds.height > 0 ? (point.y - insideBounds.top) / insideBounds.height : 0;
+		return sf::Vector2f(textureRect.left + textureRect.width * xRatio, textureRect.top + textureRect.height * yRatio);
+	};
+
+	//sf::Shape draws a triangle fan around the center, we split it into triangles so that the shapes can share one array.
+	sf::Vertex centerVertex(transform.transformPoint(center), color, texCoords(center));
+	sf::Vertex first(transform.transformPoint(points[0]), color, texCoords(points[0]));
+	sf::Vertex previous = first;
+	for (size_t i = 1; i <= points.size(); i++) {
+		sf::Vertex current = i < points.size() ? sf::Vertex(transform.transformPoint(points[i]), color, texCoords(points[i])) : first;
+		vertices.push_back(centerVertex);
+		vertices.push_back(previous);
+		vertices.push_back(current);
+		previous = current;
+	}
+}
+
+static sf::Vector2f computeNormal(sf::Vector2f p1, sf::Vector2f p2) {
+	sf::Vector2f normal(p1.y - p2.y, p2.x - p1.x);
+	float length = std::sqrt(normal.x * normal.x + normal.y * normal.y);
+	if (length != 0.f) {
+		normal /= length;
+	}
+	return normal;
+}
+
+void ShapeBatcher::computeOutline(const std::vector<sf::Vector2f>& points, sf::Vector2f center, float thickness, std::vector<sf::Vector2f>& outer) {
+	size_t count = points.size();
+	outer.resize(count);
+	for (size_t i = 0; i < count; i++) {
+		sf::Vector2f p0 = points[i == 0 ? count - 1 : i - 1];
+		sf::Vector2f p1 = points[i];
+		sf::Vector2f p2 = points[(i + 1) % count];
+
+		sf::Vector2f n1 = computeNormal(p0, p1);
+		sf::Vector2f n2 = computeNormal(p1, p2);
+		//make sure that the normals point towards the outside of the shape
+		if ((n1.x * (center.x - p1.x) + n1.y * (center.y - p1.y)) > 0) {
+			n1 = -n1;
+		}
+		if ((n2.x * (center.x - p1.x) + n2.y * (center.y - p1.y)) > 0) {
+			n2 = -n2;
+		}
+		float factor = 1.f + (n1.x * n2.x + n1.y * n2.y);
+		sf::Vector2f normal = (n1 + n2) / factor;
+		outer[i] = p1 + normal * thickness;
+	}
+}
+
+void ShapeBatcher::addOutline(const sf::Shape& shape, const sf::Transform& transform, sf::Vector2f center) {
+	sf::Color color = shape.getOutlineColor();
+	size_t count = points.size();
+	computeOutline(points, center, shape.getOutlineThickness(), outerPoints);
+
+	//sf::Shape draws the outline as a triangle strip, we emit a quad (two triangles) per edge instead
+	sf::Vertex firstInner(transform.transformPoint(points[0]), color), firstOuter(transform.transformPoint(outerPoints[0]), color);
+	sf::Vertex previousInner = firstInner, previousOuter = firstOuter;
+	for (size_t i = 1; i <= count; i++) {
+		sf::Vertex inner = i < count ? sf::Vertex(transform.transformPoint(points[i]), color) : firstInner;
+		sf::Vertex outer = i < count ? sf::Vertex(transform.transformPoint(outerPoints[i]), color) : firstOuter;
+		vertices.push_back(previousInner);
+		vertices.push_back(previousOuter);
+		vertices.push_back(inner);
+		vertices.push_back(previousOuter);
+		vertices.push_back(outer);
+		vertices.push_back(inner);
+		previousInner = inner;
+		previousOuter = outer;
+	}
+}
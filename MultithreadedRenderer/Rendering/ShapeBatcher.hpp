@@ -0,0 +1,44 @@
+#pragma once
+#include <vector>
+#include "SFML/Graphics.hpp"
+
+/** Merges consecutive sf::Shapes that use the same texture into one vertex array, so that they cost a single draw call.
+* Fills and outlines are tesselated exactly like sf::Shape does it. Everything else (e.g. sf::Text) ends the current batch and is drawn on its own,
+* so the drawing order is the same as drawing every object individually.
+* ts:: objects always use the default alpha blending, so the texture is the only state that can split a batch.*/
+class ShapeBatcher {
+public:
+	/* Starts a new frame on "target". */
+	void begin(sf::RenderTarget* target);
+
+	void addShape(const sf::Shape& shape);
+
+	/* Draws "drawable" on its own after everything that was added before. */
+	void addUnbatchable(const sf::Drawable& drawable);
+
+	/* Submits the last batch. Call once after all objects of the frame were added. */
+	void end();
+
+	//Number of draw calls submitted since the last begin()
+	unsigned int getDrawCallCount() {
+		return drawCalls;
+	}
+
+	/** The outline extrusion of sf::Shape::updateOutline, shared with RenderBackend so that batched and rasterized outlines stay the same.
+	* Writes the outer point of every point of "points" to "outer", untransformed. The inner points are "points" themselves.*/
+	static void computeOutline(const std::vector<sf::Vector2f>& points, sf::Vector2f center, float thickness, std::vector<sf::Vector2f>& outer);
+
+private:
+	sf::RenderTarget* target = nullptr;
+	std::vector<sf::Vertex> vertices;//always sf::Triangles
+	const sf::Texture* batchTexture = nullptr;
+	unsigned int drawCalls = 0;
+
+	//reused between shapes so that tesselating doesn't allocate
+	std::vector<sf::Vector2f> points, outerPoints;
+
+	void flush();
+	void useTexture(const sf::Texture* texture);
+	void addFill(const sf::Shape& shape, const sf::Transform& transform, sf::Vector2f center, const sf::FloatRect& insideBounds);
+	void addOutline(const sf::Shape& shape, const sf::Transform& transform, sf::Vector2f center);
+};
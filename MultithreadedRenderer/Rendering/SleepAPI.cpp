@@ -1,25 +1,93 @@
 #include "SleepAPI.hpp"
+#include <thread>
+#include <algorithm>
+
+#ifdef _WIN32
 #include <Windows.h>
 
 SleepAPI::SleepAPI() {
     timer = CreateWaitableTimer(NULL, TRUE, NULL);
+    spinThreshold = std::chrono::microseconds(2000);//waitable timers are only accurate to about a millisecond
 }
 
 SleepAPI::~SleepAPI() {
     CloseHandle(timer);
 }
 
-/* Windows sleep in accurate milliseconds */
-void SleepAPI::millisleep(long long ms) {
+void SleepAPI::osSleepUntil(Clock::time_point deadline) {
+    auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(deadline - Clock::now()).count();
+    if (remaining <= 0) {
+        return;
+    }
     LARGE_INTEGER li;   /* Time defintion */
 
     /* Set timer properties */
-    li.QuadPart = -ms * 10000;//convert to ns
+    li.QuadPart = -remaining * 10;//convert to 100ns, negative means relative
     if (!SetWaitableTimer(timer, &li, 0, NULL, NULL, FALSE)) {
-        CloseHandle(timer);
         return;
     }
 
     /* Start & wait for timer */
     WaitForSingleObject(timer, INFINITE);
-}
\ No newline at end of file
+}
+
+#else
+#include <time.h>
+#include <cerrno>
+
+SleepAPI::SleepAPI() {
+    timer = nullptr;//clock_nanosleep doesn't need a handle
+    spinThreshold = std::chrono::microseconds(200);
+}
+
+SleepAPI::~SleepAPI() {
+}
+
+void SleepAPI::osSleepUntil(Clock::time_point deadline) {
+    //steady_clock is CLOCK_MONOTONIC, so the deadline can be used as an absolute wake-up time. Absolute sleeps don't drift when interrupted.
+    auto sinceEpoch = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count();
+    if (sinceEpoch <= 0) {
+        return;
+    }
+    timespec wakeup;
+    wakeup.tv_sec = (time_t)(sinceEpoch / 1000000000);
+    wakeup.tv_nsec = (long)(sinceEpoch % 1000000000);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeup, nullptr) == EINTR) {
+    }
+}
+#endif
+
+void SleepAPI::millisleep(long long ms) {
+    osSleepUntil(Clock::now() + std::chrono::milliseconds(ms));
+}
+
+void SleepAPI::microsleep(long long us) {
+    sleepUntil(Clock::now() + std::chrono::microseconds(us));
+}
+
+void SleepAPI::sleepUntil(Clock::time_point deadline) {
+    if (spinThreshold > std::chrono::microseconds::zero()) {
+        osSleepUntil(deadline - spinThreshold);
+        while (Clock::now() < deadline) {
+            std::this_thread::yield();
+        }
+    }
+    else {
+        osSleepUntil(deadline);
+    }
+
+    int64_t error = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - deadline).count();
+    statisticsMtx.lock();
+    statistics.wakeups++;
+    statistics.lastError = error;
+    statistics.totalError += error;
+    statistics.maxError = (std::max)(statistics.maxError, error);
+    statisticsMtx.unlock();
+}
+
+SleepStatistics SleepAPI::getStatistics() {
+    statisticsMtx.lock();
+    SleepStatistics out = statistics;
+    statisticsMtx.unlock();
+    return out;
+}
@@ -1,9 +1,53 @@
+#pragma once
+#include <chrono>
+#include <mutex>
+#include <cstdint>
+
+//How far the wake-ups of a SleepAPI were off from their deadlines, in microseconds. Positive = woke up too late.
+struct SleepStatistics {
+    uint64_t wakeups = 0;
+    int64_t lastError = 0;
+    int64_t maxError = 0;
+    int64_t totalError = 0;
+
+    double meanError() {
+        return wakeups > 0 ? (double)totalError / wakeups : 0.0;
+    }
+};
+
+/** High resolution sleeps on Windows (waitable timers) and Linux (clock_nanosleep on the monotonic clock).
+* Deadline based sleeps can end with spinning: the thread sleeps until "spinThreshold" before the deadline and busy-waits the rest,
+* which gets the wake-up error below 100 microseconds at the cost of a bit of CPU time.*/
 class SleepAPI {
-private:
-    void* timer;
 public:
+    using Clock = std::chrono::steady_clock;
+
     SleepAPI();
     ~SleepAPI();
-    /* Windows sleep in accurate milliseconds */
+    /* Plain OS sleep, accurate to about a millisecond on Windows. Doesn't spin and isn't recorded in the statistics. */
     void millisleep(long long ms);
-};
\ No newline at end of file
+    /* Like sleepUntil */
+    void microsleep(long long us);
+    /* Plain OS sleep until "deadline", as accurate as the scheduler allows. For waits where waking up a bit late doesn't matter. */
+    void osSleepUntil(Clock::time_point deadline);
+
+    /* Sleeps until "deadline", spinning the last "spinThreshold" of it, and records how far off the wake-up was. */
+    void sleepUntil(Clock::time_point deadline);
+
+    /* How long before a deadline sleeping stops and spinning starts. Zero disables spinning. */
+    void setSpinThreshold(std::chrono::microseconds threshold) {
+        spinThreshold = threshold;
+    }
+    std::chrono::microseconds getSpinThreshold() {
+        return spinThreshold;
+    }
+
+    /* Can be called from any thread. */
+    SleepStatistics getStatistics();
+
+private:
+    void* timer;
+    std::chrono::microseconds spinThreshold;
+    SleepStatistics statistics;
+    std::mutex statisticsMtx;
+};
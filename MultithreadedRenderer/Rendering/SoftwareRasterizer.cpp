@@ -0,0 +1,404 @@
+#include "SoftwareRasterizer.hpp"
+#include "PixelKernels.hpp"
+#include "Profiler.hpp"
+#include <cmath>
+#include <algorithm>
+
+SoftwareRasterizer::SoftwareRasterizer(unsigned int width, unsigned int height, unsigned int threadCount)
+	: width(width), height(height), pixels((size_t)width * height * 4, 0), presented((size_t)width * height * 4, 0),
+	tilesX(((int)width + tileSize - 1) / tileSize), tilesY(((int)height + tileSize - 1) / tileSize),
+	tileCommands((size_t)tilesX * tilesY), tileDirty((size_t)tilesX * tilesY, 1),
+	threadCount(threadCount != 0 ? threadCount : std::max(1u, std::thread::hardware_concurrency())),
+	workers(this->threadCount - 1) {}
+
+void SoftwareRasterizer::beginFrame(sf::Color clearColor) {
+	primitiveCount = 0;
+	this->clearColor = clearColor;
+	if (clearColor != lastClearColor) {
+		allDirty = true;
+		lastClearColor = clearColor;
+	}
+	if (allDirty == true) {
+		std::fill(tileDirty.begin(), tileDirty.end(), 1);
+		allDirty = false;
+	}
+	commands.clear();
+	commandPoints.clear();
+	commandTexCoords.clear();
+	for (size_t i = 0; i < tileCommands.size(); i++) {
+		tileCommands[i].clear();
+	}
+}
+
+void SoftwareRasterizer::present() {
+	PROFILE_SCOPE("rasterizeTiles");
+	dirtyTiles.clear();
+	for (size_t tile = 0; tile < tileDirty.size(); tile++) {
+		if (tileDirty[tile] != 0) {
+			dirtyTiles.push_back((uint32_t)tile);
+		}
+	}
+	auto redraw = [this](size_t i) {
+		PROFILE_SCOPE("rasterizeTile");
+		rasterizeTile(dirtyTiles[i]);
+		copyTileToPresented(dirtyTiles[i]);
+	};
+	if (threadCount > 1) {
+		workers.parallelFor(dirtyTiles.size(), redraw);
+	}
+	else {
+		for (size_t i = 0; i < dirtyTiles.size(); i++) {
+			redraw(i);
+		}
+	}
+
+	//dirtyTiles is sorted, so neighbours in a row follow each other
+	changedRects.clear();
+	for (size_t i = 0; i < dirtyTiles.size(); i++) {
+		int tileX = (int)(dirtyTiles[i] % tilesX), tileY = (int)(dirtyTiles[i] / tilesX);
+		sf::IntRect rect(tileX * tileSize, tileY * tileSize, std::min(tileSize, (int)width - tileX * tileSize), std::min(tileSize, (int)height - tileY * tileSize));
+		if (changedRects.empty() == false && dirtyTiles[i] == dirtyTiles[i - 1] + 1 && tileX != 0) {
+			changedRects.back().width += rect.width;
+		}
+		else {
+			changedRects.push_back(rect);
+		}
+	}
+	std::fill(tileDirty.begin(), tileDirty.end(), 0);
+}
+
+//Dirty tiles----------------------------------------------------------------------------------------------------------------------------------
+
+bool SoftwareRasterizer::tileRange(const sf::FloatRect& area, int& left, int& top, int& right, int& bottom) {
+	left = std::max(0, (int)std::floor(area.left / tileSize));
+	top = std::max(0, (int)std::floor(area.top / tileSize));
+	right = std::min(tilesX - 1, (int)std::floor((area.left + area.width) / tileSize));
+	bottom = std::min(tilesY - 1, (int)std::floor((area.top + area.height) / tileSize));
+	return left <= right && top <= bottom;
+}
+
+void SoftwareRasterizer::markDirty(const sf::FloatRect& area) {
+	//a pixel of margin, bounds and the covered pixel centers can disagree by rounding
+	sf::FloatRect grown(area.left - 1.0f, area.top - 1.0f, area.width + 2.0f, area.height + 2.0f);
+	int left, top, right, bottom;
+	if (tileRange(grown, left, top, right, bottom) == false) {
+		return;
+	}
+	for (int y = top; y <= bottom; y++) {
+		std::fill(&tileDirty[(size_t)y * tilesX + left], &tileDirty[(size_t)y * tilesX + right] + 1, 1);
+	}
+}
+
+bool SoftwareRasterizer::isDirty(const sf::FloatRect& area) {
+	int left, top, right, bottom;
+	if (tileRange(area, left, top, right, bottom) == false) {
+		return false;
+	}
+	for (int y = top; y <= bottom; y++) {
+		for (int x = left; x <= right; x++) {
+			if (tileDirty[(size_t)y * tilesX + x] != 0) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+//Recording------------------------------------------------------------------------------------------------------------------------------------
+
+void SoftwareRasterizer::record(const Command& command, const sf::FloatRect& bounds) {
+	int left, top, right, bottom;
+	if (tileRange(bounds, left, top, right, bottom) == false) {//outside of the framebuffer
+		return;
+	}
+	uint32_t index = (uint32_t)commands.size();
+	bool recorded = false;
+	for (int y = top; y <= bottom; y++) {
+		for (int x = left; x <= right; x++) {
+			size_t tile = (size_t)y * tilesX + x;
+			if (tileDirty[tile] != 0) {
+				tileCommands[tile].push_back(index);
+				recorded = true;
+			}
+		}
+	}
+	if (recorded == true) {
+		commands.push_back(command);
+	}
+}
+
+uint32_t SoftwareRasterizer::storePoints(const sf::Vector2f* points, const sf::Vector2f* texCoords, size_t count) {
+	uint32_t first = (uint32_t)commandPoints.size();
+	commandPoints.insert(commandPoints.end(), points, points + count);
+	if (texCoords != nullptr) {
+		commandTexCoords.resize(first);//only textured commands store texture coordinates, keep both arrays aligned
+		commandTexCoords.insert(commandTexCoords.end(), texCoords, texCoords + count);
+	}
+	return first;
+}
+
+static sf::FloatRect pointBounds(const sf::Vector2f* points, size_t count) {
+	sf::Vector2f min = points[0], max = points[0];
+	for (size_t i = 1; i < count; i++) {
+		min.x = std::min(min.x, points[i].x); min.y = std::min(min.y, points[i].y);
+		max.x = std::max(max.x, points[i].x); max.y = std::max(max.y, points[i].y);
+	}
+	return sf::FloatRect(min.x, min.y, max.x - min.x, max.y - min.y);
+}
+
+void SoftwareRasterizer::fillPolygon(const sf::Vector2f* points, size_t count, sf::Color color) {
+	if (count < 3 || color.a == 0) {
+		return;
+	}
+	Command command;
+	command.type = CommandType::Polygon;
+	command.color = color;
+	command.firstPoint = storePoints(points, nullptr, count);
+	command.pointCount = (uint32_t)count;
+	record(command, pointBounds(points, count));
+}
+
+void SoftwareRasterizer::fillRect(const sf::FloatRect& rect, sf::Color color) {
+	if (color.a == 0) {
+		return;
+	}
+	Command command;
+	command.type = CommandType::Rect;
+	command.color = color;
+	command.rect = rect;
+	record(command, rect);
+}
+
+void SoftwareRasterizer::fillCircle(sf::Vector2f center, float radius, sf::Color color) {
+	if (color.a == 0 || radius <= 0) {
+		return;
+	}
+	Command command;
+	command.type = CommandType::Circle;
+	command.color = color;
+	command.rect = sf::FloatRect(center.x, center.y, radius, radius);
+	record(command, sf::FloatRect(center.x - radius, center.y - radius, radius * 2, radius * 2));
+}
+
+void SoftwareRasterizer::drawTexturedPolygon(const sf::Vector2f* points, const sf::Vector2f* texCoords, size_t count, const sf::Texture* texture, sf::Color tint) {
+	if (count < 3 || tint.a == 0) {
+		return;
+	}
+	//textures are resolved here, reading them back from SFML can only be done in this thread
+	const sf::Image* image = getImage(texture, false);
+	if (image == nullptr || image->getSize().x == 0 || image->getSize().y == 0) {
+		fillPolygon(points, count, tint);
+		return;
+	}
+
+	//texture coordinates are an affine function of the screen position, take its gradients from the first triangle that has an area
+	Command command;
+	bool found = false;
+	for (size_t i = 1; i + 1 < count && found == false; i++) {
+		sf::Vector2f e1 = points[i] - points[0], e2 = points[i + 1] - points[0];
+		float determinant = e1.x * e2.y - e1.y * e2.x;
+		if (std::abs(determinant) < 1e-6f) {
+			continue;
+		}
+		sf::Vector2f t1 = texCoords[i] - texCoords[0], t2 = texCoords[i + 1] - texCoords[0];
+		command.dudx = (t1.x * e2.y - t2.x * e1.y) / determinant;
+		command.dudy = (t2.x * e1.x - t1.x * e2.x) / determinant;
+		command.dvdx = (t1.y * e2.y - t2.y * e1.y) / determinant;
+		command.dvdy = (t2.y * e1.x - t1.y * e2.x) / determinant;
+		found = true;
+	}
+	if (found == false) {//no area => nothing to draw
+		return;
+	}
+	command.type = CommandType::TexturedPolygon;
+	command.color = tint;
+	command.image = image;
+	command.repeated = texture->isRepeated();
+	command.smooth = texture->isSmooth();
+	command.firstPoint = storePoints(points, texCoords, count);
+	command.pointCount = (uint32_t)count;
+	record(command, pointBounds(points, count));
+}
+
+void SoftwareRasterizer::drawGlyphRun(const sf::Vertex* vertices, size_t vertexCount, const sf::Texture* glyphTexture, bool glyphsAdded) {
+	getImage(glyphTexture, glyphsAdded);//refresh the copy once for the whole run
+	RenderBackend::drawGlyphRun(vertices, vertexCount, glyphTexture, false);
+}
+
+//Rasterizing----------------------------------------------------------------------------------------------------------------------------------
+
+void SoftwareRasterizer::rasterizeTile(size_t tile) {
+	int tileX = (int)(tile % tilesX), tileY = (int)(tile / tilesX);
+	Clip clip{ tileX * tileSize, tileY * tileSize, std::min((int)width, (tileX + 1) * tileSize), std::min((int)height, (tileY + 1) * tileSize) };
+
+	for (int row = clip.y0; row < clip.y1; row++) {
+		sf::Uint8* dst = &pixels[((size_t)row * width + clip.x0) * 4];
+		for (int x = clip.x0; x < clip.x1; x++, dst += 4) {
+			dst[0] = clearColor.r;
+			dst[1] = clearColor.g;
+			dst[2] = clearColor.b;
+			dst[3] = clearColor.a;
+		}
+	}
+
+	const std::vector<uint32_t>& indices = tileCommands[tile];
+	for (size_t i = 0; i < indices.size(); i++) {
+		const Command& command = commands[indices[i]];
+		switch (command.type) {
+		case CommandType::Polygon:
+			rasterizePolygon(command, clip);
+			break;
+		case CommandType::TexturedPolygon:
+			rasterizeTexturedPolygon(command, clip);
+			break;
+		case CommandType::Rect:
+			rasterizeRect(command, clip);
+			break;
+		case CommandType::Circle:
+			rasterizeCircle(command, clip);
+			break;
+		}
+	}
+}
+
+void SoftwareRasterizer::copyTileToPresented(size_t tile) {
+	int tileX = (int)(tile % tilesX), tileY = (int)(tile / tilesX);
+	int left = tileX * tileSize, right = std::min((int)width, left + tileSize);
+	int bottom = std::min((int)height, (tileY + 1) * tileSize);
+	for (int row = tileY * tileSize; row < bottom; row++) {
+		size_t offset = ((size_t)row * width + left) * 4;
+		std::copy(pixels.begin() + offset, pixels.begin() + offset + (size_t)(right - left) * 4, presented.begin() + offset);
+	}
+}
+
+bool SoftwareRasterizer::rowRange(float top, float bottom, const Clip& clip, int& firstRow, int& lastRow) {
+	//row y is covered if its center y + 0.5 is inside
+	firstRow = std::max(clip.y0, (int)std::ceil(top - 0.5f));
+	lastRow = std::min(clip.y1 - 1, (int)std::ceil(bottom - 0.5f) - 1);
+	return firstRow <= lastRow;
+}
+
+bool SoftwareRasterizer::columnRange(float left, float right, const Clip& clip, int& first, int& last) {
+	first = std::max(clip.x0, (int)std::ceil(left - 0.5f));
+	last = std::min(clip.x1, (int)std::ceil(right - 0.5f));
+	return first < last;
+}
+
+void SoftwareRasterizer::blendSpan(int row, float left, float right, sf::Color color, const Clip& clip) {
+	int first, last;
+	if (columnRange(left, right, clip, first, last) == false) {
+		return;
+	}
+	PixelKernels::fillSpan(&pixels[((size_t)row * width + first) * 4], last - first, color);
+}
+
+bool SoftwareRasterizer::polygonSpan(const sf::Vector2f* points, size_t count, float y, float& left, float& right) {
+	left = INFINITY;
+	right = -INFINITY;
+	for (size_t i = 0; i < count; i++) {
+		const sf::Vector2f& a = points[i];
+		const sf::Vector2f& b = points[(i + 1) % count];
+		if ((a.y <= y && b.y > y) || (b.y <= y && a.y > y)) {
+			float x = a.x + (y - a.y) * (b.x - a.x) / (b.y - a.y);
+			left = std::min(left, x);
+			right = std::max(right, x);
+		}
+	}
+	return left < right;
+}
+
+void SoftwareRasterizer::rasterizePolygon(const Command& command, const Clip& clip) {
+	const sf::Vector2f* points = &commandPoints[command.firstPoint];
+	sf::FloatRect bounds = pointBounds(points, command.pointCount);
+	int firstRow, lastRow;
+	if (rowRange(bounds.top, bounds.top + bounds.height, clip, firstRow, lastRow) == false) {
+		return;
+	}
+	float left, right;
+	for (int row = firstRow; row <= lastRow; row++) {
+		if (polygonSpan(points, command.pointCount, row + 0.5f, left, right) == true) {
+			blendSpan(row, left, right, command.color, clip);
+		}
+	}
+}
+
+void SoftwareRasterizer::rasterizeRect(const Command& command, const Clip& clip) {
+	const sf::FloatRect& rect = command.rect;
+	int firstRow, lastRow;
+	if (rowRange(rect.top, rect.top + rect.height, clip, firstRow, lastRow) == false) {
+		return;
+	}
+	for (int row = firstRow; row <= lastRow; row++) {
+		blendSpan(row, rect.left, rect.left + rect.width, command.color, clip);
+	}
+}
+
+void SoftwareRasterizer::rasterizeCircle(const Command& command, const Clip& clip) {
+	sf::Vector2f center(command.rect.left, command.rect.top);
+	float radius = command.rect.width;
+	int firstRow, lastRow;
+	if (rowRange(center.y - radius, center.y + radius, clip, firstRow, lastRow) == false) {
+		return;
+	}
+	for (int row = firstRow; row <= lastRow; row++) {
+		float dy = row + 0.5f - center.y;
+		float halfWidth = std::sqrt(std::max(0.0f, radius * radius - dy * dy));
+		blendSpan(row, center.x - halfWidth, center.x + halfWidth, command.color, clip);
+	}
+}
+
+void SoftwareRasterizer::rasterizeTexturedPolygon(const Command& command, const Clip& clip) {
+	const sf::Vector2f* points = &commandPoints[command.firstPoint];
+	const sf::Vector2f* texCoords = &commandTexCoords[command.firstPoint];
+	sf::FloatRect bounds = pointBounds(points, command.pointCount);
+	int firstRow, lastRow;
+	if (rowRange(bounds.top, bounds.top + bounds.height, clip, firstRow, lastRow) == false) {
+		return;
+	}
+
+	PixelKernels::TextureSpan span;
+	span.texels = command.image->getPixelsPtr();
+	span.width = (int)command.image->getSize().x;
+	span.height = (int)command.image->getSize().y;
+	span.dudx = command.dudx;
+	span.dvdx = command.dvdx;
+	span.repeated = command.repeated;
+	span.smooth = command.smooth;
+	span.tint = command.color;
+	float left, right;
+	for (int row = firstRow; row <= lastRow; row++) {
+		float y = row + 0.5f;
+		int first, last;
+		if (polygonSpan(points, command.pointCount, y, left, right) == false || columnRange(left, right, clip, first, last) == false) {
+			continue;
+		}
+		//texture coordinates at the center of the first pixel
+		span.u = texCoords[0].x + command.dudx * (first + 0.5f - points[0].x) + command.dudy * (y - points[0].y);
+		span.v = texCoords[0].y + command.dvdx * (first + 0.5f - points[0].x) + command.dvdy * (y - points[0].y);
+		PixelKernels::texturedSpan(&pixels[((size_t)row * width + first) * 4], last - first, span);
+	}
+}
+
+//Textures-------------------------------------------------------------------------------------------------------------------------------------
+
+void SoftwareRasterizer::onTextureLoaded(const sf::Texture* texture, const sf::IntRect& rect, const sf::Image& image) {
+	sf::Image& copy = images[texture];
+	if (copy.getSize() != texture->getSize()) {//new texture or atlas page
+		copy.create(texture->getSize().x, texture->getSize().y, sf::Color::Transparent);
+	}
+	copy.copy(image, rect.left, rect.top);
+}
+
+const sf::Image* SoftwareRasterizer::getImage(const sf::Texture* texture, bool outdated) {
+	if (texture == nullptr) {
+		return nullptr;
+	}
+	auto it = images.find(texture);
+	if (it != images.end() && outdated == false && it->second.getSize() == texture->getSize()) {
+		return &it->second;
+	}
+	//never loaded through the Renderer (or changed since), read it back from SFML
+	sf::Image& copy = images[texture];
+	copy = texture->copyToImage();
+	return &copy;
+}
\ No newline at end of file
@@ -0,0 +1,110 @@
+#pragma once
+#include <vector>
+#include <unordered_map>
+#include "RenderBackend.hpp"
+#include "ThreadPool.hpp"
+
+/** Reference backend that rasterizes on the CPU into an RGBA framebuffer, so scenes can be drawn and benchmarked without a GPU.
+* Pixels are covered if their center is inside of a primitive (no antialiasing), textures are sampled with the nearest texel
+* (bilinear if they are smooth) and everything is alpha blended like SFML's default blend mode. Spans are drawn with the PixelKernels.
+* Primitives are only recorded while drawing. present() sorts them into tiles of tileSize x tileSize pixels and rasterizes the tiles in parallel,
+* every tile executes its primitives in drawing order, so the result is the same as drawing them one after another.
+* Only tiles touched by a dirty area (see markDirty) are redrawn, the others keep their pixels from the last frame.
+* Textures are kept as sf::Images that are filled through onTextureLoaded, so set it as backend before textures are loaded.
+* Textures it never got (e.g. font glyphs) are read back from SFML once and whenever they changed.*/
+class SoftwareRasterizer : public RenderBackend {
+public:
+	static constexpr int tileSize = 64;
+
+	/* "threadCount" = 0 uses all cores (the thread that calls present() works on tiles as well). */
+	SoftwareRasterizer(unsigned int width, unsigned int height, unsigned int threadCount = 0);
+
+	void beginFrame(sf::Color clearColor) override;
+	void present() override;
+	sf::Vector2u getSize() override {
+		return sf::Vector2u(width, height);
+	}
+
+	void fillPolygon(const sf::Vector2f* points, size_t count, sf::Color color) override;
+	void drawTexturedPolygon(const sf::Vector2f* points, const sf::Vector2f* texCoords, size_t count, const sf::Texture* texture, sf::Color tint) override;
+	void fillRect(const sf::FloatRect& rect, sf::Color color) override;
+	void fillCircle(sf::Vector2f center, float radius, sf::Color color) override;
+	void drawGlyphRun(const sf::Vertex* vertices, size_t vertexCount, const sf::Texture* glyphTexture, bool glyphsAdded) override;
+
+	void markDirty(const sf::FloatRect& area) override;
+	void markAllDirty() override {
+		allDirty = true;
+	}
+	bool isDirty(const sf::FloatRect& area) override;
+	void getChangedRects(std::vector<sf::IntRect>& rects) override {
+		rects.insert(rects.end(), changedRects.begin(), changedRects.end());
+	}
+
+	void onTextureLoaded(const sf::Texture* texture, const sf::IntRect& rect, const sf::Image& image) override;
+
+	const sf::Uint8* getFramebuffer() override {
+		return presented.data();
+	}
+
+private:
+	enum class CommandType { Polygon, TexturedPolygon, Rect, Circle };
+	//One recorded primitive. Points and texture coordinates are in the frame's point arrays.
+	struct Command {
+		CommandType type;
+		sf::Color color;
+		uint32_t firstPoint = 0, pointCount = 0;
+		sf::FloatRect rect;//Rect: the rect, Circle: center in left/top and radius in width
+		//TexturedPolygon: texture coordinate at the first point and its change per pixel
+		const sf::Image* image = nullptr;
+		bool repeated = false, smooth = false;
+		float dudx = 0, dudy = 0, dvdx = 0, dvdy = 0;
+	};
+	//pixels of a tile, x1 and y1 exclusive
+	struct Clip {
+		int x0, y0, x1, y1;
+	};
+
+	unsigned int width, height;
+	//frame that is drawn and the last presented one, present() copies the redrawn tiles over
+	std::vector<sf::Uint8> pixels, presented;
+	std::unordered_map<const sf::Texture*, sf::Image> images;
+
+	sf::Color clearColor, lastClearColor;
+	std::vector<Command> commands;
+	std::vector<sf::Vector2f> commandPoints, commandTexCoords;
+	int tilesX, tilesY;
+	//indices into "commands" per tile, in drawing order
+	std::vector<std::vector<uint32_t>> tileCommands;
+	//1 for tiles that are redrawn in this frame, reset by present()
+	std::vector<sf::Uint8> tileDirty;
+	bool allDirty = true;
+	std::vector<uint32_t> dirtyTiles;
+	//redrawn tiles of the last present(), neighbours in a row merged
+	std::vector<sf::IntRect> changedRects;
+	//threads rasterizing tiles including the one calling present(), the pool has one less (but at least one)
+	unsigned int threadCount;
+	ThreadPool workers;
+
+	const sf::Image* getImage(const sf::Texture* texture, bool outdated);
+	/* Tiles touched by "area", false if it is outside of the framebuffer. */
+	bool tileRange(const sf::FloatRect& area, int& left, int& top, int& right, int& bottom);
+	/* Adds the command to every dirty tile that "bounds" touches. */
+	void record(const Command& command, const sf::FloatRect& bounds);
+	uint32_t storePoints(const sf::Vector2f* points, const sf::Vector2f* texCoords, size_t count);
+
+	void rasterizeTile(size_t tile);
+	void copyTileToPresented(size_t tile);
+	void rasterizePolygon(const Command& command, const Clip& clip);
+	void rasterizeTexturedPolygon(const Command& command, const Clip& clip);
+	void rasterizeRect(const Command& command, const Clip& clip);
+	void rasterizeCircle(const Command& command, const Clip& clip);
+
+	/* First and last row whose pixel centers are inside of [top, bottom), clipped. Returns false if there are none. */
+	static bool rowRange(float top, float bottom, const Clip& clip, int& firstRow, int& lastRow);
+	/* First and one past the last column whose pixel centers are inside of [left, right), clipped. Returns false if there are none. */
+	static bool columnRange(float left, float right, const Clip& clip, int& first, int& last);
+	/* Blends "color" over the pixels of "row" whose centers are inside of [left, right). */
+	void blendSpan(int row, float left, float right, sf::Color color, const Clip& clip);
+	/* Horizontal extent of a convex polygon at the height "y". Returns false if it doesn't reach that height. */
+	static bool polygonSpan(const sf::Vector2f* points, size_t count, float y, float& left, float& right);
+};
\ No newline at end of file
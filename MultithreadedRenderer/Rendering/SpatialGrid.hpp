@@ -0,0 +1,173 @@
+#pragma once
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include "SFML/Graphics.hpp"
+
+//Cells of the SpatialGrid covered by an item, inclusive. Empty if the item isn't in the grid.
+struct GridCellRange {
+	int left = 0, top = 0, right = -1, bottom = -1;
+	//too big for the cells, kept in a list that every query looks at
+	bool large = false;
+
+	bool isEmpty() const {
+		return right < left;
+	}
+};
+
+/** Uniform grid over an unbounded plane that finds the items intersecting a rect without looking at the others.
+* Only the cells that contain items are allocated. Items are inserted into every cell their bounds touch (items that would touch more than
+* "maxCellsPerItem" cells, like backgrounds, go into one list instead). The caller keeps the returned GridCellRange and passes it back to move
+* or remove the item. Not thread safe.*/
+template<class T>
+class SpatialGrid {
+	struct Entry {
+		T item;
+		sf::FloatRect bounds;
+		GridCellRange cells;
+	};
+
+	static constexpr int64_t maxCellsPerItem = 64;
+
+	float cellSize;
+	std::unordered_map<uint64_t, std::vector<Entry>> cells;
+	std::vector<Entry> largeItems;
+	size_t itemCount = 0;
+
+	static uint64_t cellKey(int x, int y) {
+		return ((uint64_t)(uint32_t)x << 32) | (uint32_t)y;
+	}
+
+	int cellOf(float coordinate) const {
+		//clamped so that far away coordinates can't overflow
+		return (int)std::clamp(std::floor(coordinate / cellSize), -1073741824.0f, 1073741824.0f);
+	}
+
+	GridCellRange cellsOf(const sf::FloatRect& bounds) const {
+		GridCellRange range;
+		range.left = cellOf(bounds.left);
+		range.top = cellOf(bounds.top);
+		range.right = cellOf(bounds.left + bounds.width);
+		range.bottom = cellOf(bounds.top + bounds.height);
+		return range;
+	}
+
+public:
+	SpatialGrid(float cellSize = 256.0f) : cellSize(cellSize) {}
+
+	/* Adds "item" with "bounds" and returns the cells it is in now. Bounds without area are not inserted. */
+	GridCellRange insert(T item, const sf::FloatRect& bounds) {
+		if (bounds.width <= 0 || bounds.height <= 0) {
+			return GridCellRange();
+		}
+		GridCellRange range = cellsOf(bounds);
+		itemCount++;
+		if (((int64_t)range.right - range.left + 1) * ((int64_t)range.bottom - range.top + 1) > maxCellsPerItem) {
+			range.large = true;
+			largeItems.push_back(Entry{ item, bounds, range });
+			return range;
+		}
+		for (int y = range.top; y <= range.bottom; y++) {
+			for (int x = range.left; x <= range.right; x++) {
+				cells[cellKey(x, y)].push_back(Entry{ item, bounds, range });
+			}
+		}
+		return range;
+	}
+
+	/* Removes "item" from the cells it was inserted into. "range" is the value returned by insert. */
+	void remove(T item, const GridCellRange& range) {
+		if (range.isEmpty() == true) {
+			return;
+		}
+		itemCount--;
+		if (range.large == true) {
+			for (size_t i = 0; i < largeItems.size(); i++) {
+				if (largeItems[i].item == item) {
+					largeItems[i] = largeItems.back();
+					largeItems.pop_back();
+					break;
+				}
+			}
+			return;
+		}
+		for (int y = range.top; y <= range.bottom; y++) {
+			for (int x = range.left; x <= range.right; x++) {
+				auto cell = cells.find(cellKey(x, y));
+				if (cell == cells.end()) {
+					continue;
+				}
+				std::vector<Entry>& entries = cell->second;
+				for (size_t i = 0; i < entries.size(); i++) {
+					if (entries[i].item == item) {//order inside of a cell doesn't matter
+						entries[i] = entries.back();
+						entries.pop_back();
+						break;
+					}
+				}
+				if (entries.empty() == true) {
+					cells.erase(cell);
+				}
+			}
+		}
+	}
+
+	/* Moves "item" to "bounds". Returns the new range, which replaces "range". */
+	GridCellRange move(T item, const GridCellRange& range, const sf::FloatRect& bounds) {
+		remove(item, range);
+		return insert(item, bounds);
+	}
+
+	/** Calls "found" once for every item whose bounds intersect "area", in no particular order.
+	* If "area" covers more cells than are allocated, the allocated ones are walked instead, so zooming far out never costs more than the items.*/
+	template<class Callback>
+	void query(const sf::FloatRect& area, Callback&& found) const {
+		if (itemCount == 0) {
+			return;
+		}
+		for (const Entry& entry : largeItems) {
+			if (entry.bounds.intersects(area) == true) {
+				found(entry.item, entry.bounds);
+			}
+		}
+		GridCellRange range = cellsOf(area);
+		//an item in several cells is only reported by the first of its cells inside of the queried range
+		auto visit = [&](int x, int y, const std::vector<Entry>& entries) {
+			for (const Entry& entry : entries) {
+				if (x == std::max(entry.cells.left, range.left) && y == std::max(entry.cells.top, range.top) && entry.bounds.intersects(area) == true) {
+					found(entry.item, entry.bounds);
+				}
+			}
+		};
+		int64_t rangeCells = ((int64_t)range.right - range.left + 1) * ((int64_t)range.bottom - range.top + 1);
+		if (rangeCells > (int64_t)cells.size()) {
+			for (const auto& [key, entries] : cells) {
+				int x = (int)(int32_t)(uint32_t)(key >> 32), y = (int)(int32_t)(uint32_t)key;
+				if (x >= range.left && x <= range.right && y >= range.top && y <= range.bottom) {
+					visit(x, y, entries);
+				}
+			}
+			return;
+		}
+		for (int y = range.top; y <= range.bottom; y++) {
+			for (int x = range.left; x <= range.right; x++) {
+				auto cell = cells.find(cellKey(x, y));
+				if (cell != cells.end()) {
+					visit(x, y, cell->second);
+				}
+			}
+		}
+	}
+
+	size_t getItemCount() const {
+		return itemCount;
+	}
+
+	void clear() {
+		cells.clear();
+		largeItems.clear();
+		itemCount = 0;
+	}
+};
@@ -0,0 +1,67 @@
+#include "TextureAtlas.hpp"
+#include <algorithm>
+
+TextureAtlas::~TextureAtlas() {
+	for (size_t i = 0; i < pages.size(); i++) {
+		delete pages[i];
+	}
+}
+
+bool TextureAtlas::insert(const sf::Image& image, LoadedTexture& out) {
+	sf::Vector2u size = image.getSize();
+	if (size.x == 0 || size.y == 0 || size.x > maxEntrySize || size.y > maxEntrySize) {
+		return false;
+	}
+	if (pageSize == 0) {
+		pageSize = std::min(2048u, sf::Texture::getMaximumSize());
+	}
+
+	sf::Vector2u position;
+	Page* target = nullptr;
+	for (size_t i = 0; i < pages.size() && target == nullptr; i++) {
+		if (insertIntoPage(*pages[i], size.x, size.y, position) == true) {
+			target = pages[i];
+		}
+	}
+	if (target == nullptr) {//all pages are full
+		Page* page = new Page();
+		if (page->texture.create(pageSize, pageSize) == false || insertIntoPage(*page, size.x, size.y, position) == false) {
+			delete page;
+			return false;
+		}
+		pages.push_back(page);
+		target = page;
+	}
+
+	target->texture.update(image, position.x, position.y);
+	out.texture = &target->texture;
+	out.rect = sf::IntRect((int)position.x, (int)position.y, (int)size.x, (int)size.y);
+	return true;
+}
+
+bool TextureAtlas::insertIntoPage(Page& page, unsigned int width, unsigned int height, sf::Vector2u& position) {
+	unsigned int paddedWidth = width + padding, paddedHeight = height + padding;
+
+	//best fit: the shelf with the least unused height that still has room
+	Shelf* best = nullptr;
+	for (size_t i = 0; i < page.shelves.size(); i++) {
+		Shelf& shelf = page.shelves[i];
+		if (shelf.height >= paddedHeight && shelf.usedWidth + paddedWidth <= pageSize) {
+			if (best == nullptr || shelf.height < best->height) {
+				best = &shelf;
+			}
+		}
+	}
+	if (best == nullptr) {//open a new shelf below the others
+		if (page.usedHeight + paddedHeight > pageSize || paddedWidth > pageSize) {
+			return false;
+		}
+		page.shelves.push_back(Shelf{ page.usedHeight, paddedHeight, 0 });
+		page.usedHeight += paddedHeight;
+		best = &page.shelves.back();
+	}
+
+	position = sf::Vector2u(best->usedWidth, best->y);
+	best->usedWidth += paddedWidth;
+	return true;
+}
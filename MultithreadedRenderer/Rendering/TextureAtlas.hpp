@@ -0,0 +1,46 @@
+#pragma once
+#include <vector>
+#include "SFML/Graphics.hpp"
+
+//A texture as it is applied to shapes: either a standalone texture (rect covers all of it) or a region of an atlas page.
+struct LoadedTexture {
+	sf::Texture* texture = nullptr;
+	sf::IntRect rect;
+};
+
+/** Packs small images into shared texture pages, so that shapes with different images can still be batched into one draw call.
+* Every page is filled shelf by shelf (rows with the height of their first image), images go on the shelf that wastes the least height.
+* Only use in the rendering thread, creating and updating pages needs the active OpenGL context.*/
+class TextureAtlas {
+public:
+	//Images that are larger in any dimension stay standalone textures.
+	static constexpr unsigned int maxEntrySize = 256;
+
+	TextureAtlas() {}
+	TextureAtlas(const TextureAtlas&) = delete;
+	~TextureAtlas();
+
+	/* Copies "image" into a page and writes page and region to "out". Returns false if the image is too large for the atlas. */
+	bool insert(const sf::Image& image, LoadedTexture& out);
+
+	size_t getPageCount() {
+		return pages.size();
+	}
+
+private:
+	//1 pixel between images, so that neighbours don't bleed into each other at the edges
+	static constexpr unsigned int padding = 1;
+
+	struct Shelf {
+		unsigned int y, height, usedWidth;
+	};
+	struct Page {
+		sf::Texture texture;
+		std::vector<Shelf> shelves;
+		unsigned int usedHeight = 0;
+	};
+	std::vector<Page*> pages;
+	unsigned int pageSize = 0;
+
+	bool insertIntoPage(Page& page, unsigned int width, unsigned int height, sf::Vector2u& position);
+};
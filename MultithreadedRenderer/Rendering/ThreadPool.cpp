@@ -0,0 +1,71 @@
+#include "ThreadPool.hpp"
+#include <algorithm>
+
+ThreadPool::ThreadPool(unsigned int threadCount) {
+	if (threadCount == 0) {
+		threadCount = 1;
+	}
+	for (unsigned int i = 0; i < threadCount; i++) {
+		workers.emplace_back(&ThreadPool::work, this);
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	jobMtx.lock();
+	stopping = true;
+	jobMtx.unlock();
+	jobAvailable.notify_all();
+	for (size_t i = 0; i < workers.size(); i++) {
+		workers[i].join();
+	}
+}
+
+void ThreadPool::enqueue(std::function<void()> job) {
+	jobMtx.lock();
+	jobs.push_back(std::move(job));
+	jobMtx.unlock();
+	jobAvailable.notify_one();
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& job) {
+	std::atomic<size_t> next = 0;
+	auto takeIndices = [&]() {
+		size_t i;
+		while ((i = next.fetch_add(1, std::memory_order_relaxed)) < count) {
+			job(i);
+		}
+	};
+
+	size_t helpers = count > 1 ? std::min(workers.size(), count - 1) : 0;
+	size_t finishedHelpers = 0;
+	std::mutex doneMtx;
+	std::condition_variable done;
+	for (size_t h = 0; h < helpers; h++) {
+		enqueue([&]() {
+			takeIndices();
+			//notify under the lock, the waiting thread destroys "done" as soon as it sees the last helper finish
+			std::lock_guard<std::mutex> lock(doneMtx);
+			finishedHelpers++;
+			done.notify_one();
+		});
+	}
+	takeIndices();
+	std::unique_lock<std::mutex> lock(doneMtx);
+	done.wait(lock, [&] { return finishedHelpers == helpers; });
+}
+
+void ThreadPool::work() {
+	while (true) {
+		std::function<void()> job;
+		{
+			std::unique_lock<std::mutex> lock(jobMtx);
+			jobAvailable.wait(lock, [this] { return stopping == true || jobs.empty() == false; });
+			if (jobs.empty() == true) {//only happens when stopping
+				return;
+			}
+			job = std::move(jobs.front());
+			jobs.pop_front();
+		}
+		job();
+	}
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+
+/** Fixed number of worker threads that execute queued jobs in FIFO order.
+* The destructor finishes all queued jobs before joining the workers.*/
+class ThreadPool {
+public:
+	ThreadPool(unsigned int threadCount);
+	ThreadPool(const ThreadPool&) = delete;
+	~ThreadPool();
+
+	/* Can be called from any thread. */
+	void enqueue(std::function<void()> job);
+
+	/** Calls "job" with every index from 0 to count - 1 and returns when all calls are finished. The calling thread works on the indices as well,
+	* the others are taken by the workers one at a time, so uneven jobs are balanced. Don't call it from a job of the same pool.*/
+	void parallelFor(size_t count, const std::function<void(size_t)>& job);
+
+	unsigned int getThreadCount() {
+		return (unsigned int)workers.size();
+	}
+
+private:
+	std::vector<std::thread> workers;
+	std::deque<std::function<void()>> jobs;
+	std::mutex jobMtx;
+	std::condition_variable jobAvailable;
+	bool stopping = false;
+
+	void work();
+};
@@ -1,31 +1,198 @@
 #include "ThreadSafeObjects.hpp"
 #include "Renderer.hpp"
+#include <algorithm>
 
 //This cpp only exists, because ThreadSafeObjects.hpp and Renderer.hpp would include each other => We implement functions that use the Renderer here.
 
 void ts::Drawable::initDrawableAfterConstruction(sf::Drawable* drawable) {
     this->drawable = drawable;
+    backTransformable = dynamic_cast<sf::Transformable*>(drawable);
     Renderer::addPermanentObject(this);
 }
 
 ts::Drawable::~Drawable() {
     Renderer::removePermanentObject(this);
-}
-
-void ts::Drawable::draw() {
-    Renderer::window->draw(*drawable);
+    Renderer::cancelTextureLoading(drawable);
+    Renderer::stopMotion(this, false);
+    //the last snapshot may still point to the front buffer, so the Renderer frees it once that snapshot is gone
+    if (frontBuffer != nullptr) {
+        Renderer::retireFrontBuffer(frontBuffer);
+        frontBuffer = nullptr;
+    }
 }
 
 void ts::Drawable::prepareApplyingChanges() {
     //if multiple things were changed this frame, only add to renderer once
-    if (addedAsChanged == false) {
+    if (addedAsChanged.exchange(true, std::memory_order_acq_rel) == false) {
         Renderer::addAsChangedObject(this);
-        addedAsChanged = true;
+        Renderer::requestRedraw();
     }
 }
 
+void ts::Drawable::requestRedraw() {
+    changedSinceSnapshot.store(true, std::memory_order_release);
+    Renderer::requestRedraw();
+}
+
+void ts::Drawable::setLayer(int layer) {
+    Renderer::changeLayer(this, layer);
+}
+
+int ts::Drawable::getLayer() {
+    return Renderer::getLayer(this);
+}
+
+void ts::Drawable::readTransform(sf::Vector2f& position, float& rotation) {
+    mtx.lock();
+    position = backTransformable->getPosition();
+    rotation = backTransformable->getRotation();
+    mtx.unlock();
+}
+
+void ts::Drawable::writeTransform(sf::Vector2f position, float rotation) {
+    mtx.lock();
+    backTransformable->setPosition(position);
+    backTransformable->setRotation(rotation);
+    mtx.unlock();
+    requestRedraw();
+}
+
+void ts::Drawable::setMotion(sf::Vector2f velocity, sf::Vector2f acceleration, float angularVelocity) {
+    Renderer::setMotion(this, velocity, acceleration, angularVelocity);
+}
+
+void ts::Drawable::stopMotion() {
+    Renderer::stopMotion(this, true);
+}
+
+ts::MotionState ts::Drawable::syncMotion() {
+    return Renderer::syncMotion(this);
+}
+
+void ts::Shape::readTransform(sf::Vector2f& position, float& rotation) {
+    actualDataMtx.lock();
+    position = sf::Vector2f(actualX, actualY);
+    actualDataMtx.unlock();
+    mtx.lock();
+    rotation = shape->getRotation();
+    mtx.unlock();
+}
+
+void ts::Shape::writeTransform(sf::Vector2f position, float rotation) {
+    transform(position.x, position.y);
+    mtx.lock();
+    shape->setRotation(rotation);
+    mtx.unlock();
+    requestRedraw();
+}
+
 void ts::Shape::addTexture(std::string texturePath, bool repeat) {
-    Renderer::queueTextureLoading(texturePath, repeat, shape);
+    Renderer::queueTextureLoading(texturePath, repeat, shape, this);
+}
+
+void ts::Shape::recordTickState() {
+    //made by the tick that is running right now (outside of the event loop: counts for the next one)
+    TickState state{ Renderer::getCompletedTicks() + 1, sf::Vector2f(actualX, actualY), getActualSize() };
+    if (tickStateCount > 0 && tickStates[tickStateCount - 1].tick == state.tick) {//changed again in the same tick
+        tickStates[tickStateCount - 1] = state;
+        return;
+    }
+    if (tickStateCount == tickStateCapacity) {
+        std::move(tickStates + 1, tickStates + tickStateCapacity, tickStates);
+        tickStateCount--;
+    }
+    tickStates[tickStateCount++] = state;
+}
+
+bool ts::Shape::interpolate(uint64_t latestTick, float alpha) {
+    if (frontShape == nullptr) {
+        return false;
+    }
+    actualDataMtx.lock();
+    //"to" is where the last completed tick left this shape, "from" where the tick before it did
+    int last = -1;
+    for (int i = 0; i < tickStateCount; i++) {
+        if (tickStates[i].tick <= latestTick) {
+            last = i;
+        }
+    }
+    if (last == -1) {
+        actualDataMtx.unlock();
+        return false;
+    }
+    TickState to = tickStates[last];
+    TickState from = (to.tick == latestTick && last > 0) ? tickStates[last - 1] : to;
+    //changed by the tick that is still running, don't show it before it is completed
+    bool pending = tickStates[tickStateCount - 1].tick > latestTick;
+    actualDataMtx.unlock();
+
+    bool moving = to.tick == latestTick && from.tick != to.tick;
+    if (moving == false && pending == false && frontInterpolated == false) {//the front buffer already is at the latest state
+        return false;
+    }
+    frontShape->setPosition(from.position + (to.position - from.position) * alpha);
+    writeFrontSize(from.size + (to.size - from.size) * alpha);
+    frontBounds = frontShape->getGlobalBounds();
+    //once neither is true anymore, the state written now is the latest one
+    frontInterpolated = moving == true || pending == true;
+    return true;
+}
+
+void ts::Shape::readTweenValue(TweenProperty property, float* value) {
+    actualDataMtx.lock();
+    switch (property) {
+    case TweenProperty::Position:
+        value[0] = actualX;
+        value[1] = actualY;
+        break;
+    case TweenProperty::Size: {
+        sf::Vector2f size = getActualSize();
+        value[0] = size.x;
+        value[1] = size.y;
+        break;
+    }
+    case TweenProperty::Color:
+        value[0] = actualColor.r;
+        value[1] = actualColor.g;
+        value[2] = actualColor.b;
+        value[3] = actualColor.a;
+        break;
+    case TweenProperty::Alpha:
+        value[0] = actualColor.a;
+        break;
+    }
+    actualDataMtx.unlock();
+}
+
+static sf::Uint8 toColorChannel(float value) {
+    return (sf::Uint8)std::clamp(value + 0.5f, 0.0f, 255.0f);
+}
+
+void ts::Shape::writeTweenValue(TweenProperty property, const float* value) {
+    actualDataMtx.lock();
+    switch (property) {
+    case TweenProperty::Position:
+        actualX = value[0];
+        actualY = value[1];
+        shape->setPosition(actualX, actualY);
+        break;
+    case TweenProperty::Size:
+        writeActualSize(sf::Vector2f(value[0], value[1]));
+        break;
+    case TweenProperty::Color:
+        actualColor = sf::Color(toColorChannel(value[0]), toColorChannel(value[1]), toColorChannel(value[2]), toColorChannel(value[3]));
+        shape->setFillColor(actualColor);
+        break;
+    case TweenProperty::Alpha:
+        actualColor.a = toColorChannel(value[0]);
+        shape->setFillColor(actualColor);
+        break;
+    }
+    //tweens already move every frame, interpolating between ticks would only hold them back, so the history starts over as committed
+    tickStates[0] = TickState{ Renderer::getCompletedTicks(), sf::Vector2f(actualX, actualY), getActualSize() };
+    tickStateCount = 1;
+    actualDataMtx.unlock();
+    markChangedSinceSnapshot();
 }
 
 static std::map<std::string, sf::Font*> loadedFonts;//we don't need to delete the fonts because this static map will persist until the program ends.
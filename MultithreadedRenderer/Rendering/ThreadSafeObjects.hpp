@@ -1,28 +1,105 @@
 #pragma once
 #include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
 #include "SFML/Graphics.hpp"
+#include "Tween.hpp"
+#include "Kinematics.hpp"
+#include "LockProfiler.hpp"
+#include "SpatialGrid.hpp"
+class Renderer;
+struct DrawLayer;
 namespace ts {
 	class Drawable {
+		friend class ::Renderer;
+		friend struct ::DrawLayer;
+	private:
+		//Key of the layer in Renderer::permanentObjects and index in that layer, -1 while not registered. Only touched under Renderer::permanentObjectMtx.
+		int layer = defaultLayer;
+		int registrySlot = -1;
+
+		//Set whenever the drawable changed since the last snapshot, so that the Renderer only copies changed drawables. Reset by the Renderer.
+		std::atomic<bool> changedSinceSnapshot = true;
+		//Visibility and bounds of the front buffer in the last snapshot. Only touched by the Renderer under permanentObjectMtx.
+		bool snapshotShown = false;
+		sf::FloatRect snapshotBounds;
+		//Cells of Renderer::cullingGrid that snapshotBounds is in while shown. Only touched by the Renderer under permanentObjectMtx.
+		GridCellRange cullingCells;
+		//Set once a tween was added for this drawable, so that the Renderer drops its tweens when it is deleted
+		std::atomic<bool> hasTweens = false;
+		//Index in Renderer::kinematics, -1 while not moving. Only touched under Renderer::kinematicsMtx.
+		int kinematicSlot = -1;
 	protected:
-		std::mutex mtx;
+		ProfiledMutex mtx{ "Drawable::mtx" };
 		sf::Drawable* drawable = nullptr;
-		std::mutex drawMeMtx;
+		ProfiledMutex drawMeMtx{ "Drawable::drawMeMtx" };
 		bool drawMe = true;
 		void initDrawableAfterConstruction(sf::Drawable* drawable);
 
-		//used so that we dont add the same drawable multiple times to the Renderer. reset in Drawable::applyChanges, so call this when overriding!
-		bool addedAsChanged = false;
+		//used so that we dont add the same drawable multiple times to the Renderer's change queue. reset in Drawable::applyChanges, so call this when overriding!
+		//Atomic because it is set by any thread that changes the drawable and reset by the rendering thread.
+		std::atomic<bool> addedAsChanged = false;
 		void prepareApplyingChanges();
+		//Call after every change that does not go through prepareApplyingChanges, so that the Renderer draws it even in on-demand mode.
+		void requestRedraw();
+		//For changes made by the rendering thread itself, which doesn't have to be woken up
+		void markChangedSinceSnapshot() {
+			changedSinceSnapshot.store(true, std::memory_order_release);
+		}
+
+		//Unique for every drawable ever constructed. Lets the Renderer recognize queued changes of deleted drawables without touching them.
+		const uint64_t serial;
+		static inline std::atomic<uint64_t> nextSerial = 0;
+
+		//Copy of "drawable" that only the rendering thread reads. It is refreshed once per frame while the drawable is locked, so the draw pass never has to hold "mtx".
+		sf::Drawable* frontBuffer = nullptr;
+		//Same object as frontBuffer if it is an sf::Shape (can be batched with other shapes), nullptr otherwise.
+		sf::Shape* frontShape = nullptr;
+		//Screen space bounds of the front buffer
+		sf::FloatRect frontBounds;
+		//Transformable parts of "drawable" and the front buffer, for moving them without knowing their type
+		sf::Transformable* backTransformable = nullptr;
+		sf::Transformable* frontTransformable = nullptr;
+		sf::FloatRect frontLocalBounds;
+
+		template<class T>
+		void writeFrontBuffer(const T& back) {
+			if (frontBuffer == nullptr) {
+				T* front = new T(back);
+				frontBuffer = front;
+				if constexpr (std::is_base_of_v<sf::Shape, T>) {
+					frontShape = front;
+				}
+				if constexpr (std::is_base_of_v<sf::Transformable, T>) {
+					frontTransformable = front;
+				}
+			}
+			else {
+				*static_cast<T*>(frontBuffer) = back;
+			}
+			frontLocalBounds = back.getLocalBounds();
+			frontBounds = back.getGlobalBounds();
+		}
+
+		//Position and rotation as set by the game thread. Overridden by drawables that keep their own copy of the position.
+		virtual void readTransform(sf::Vector2f& position, float& rotation);
+		virtual void writeTransform(sf::Vector2f position, float rotation);
 
 	public:
-		Drawable() {}
+		//Layers are drawn from the lowest to the highest. Inside of a layer, drawables are drawn in the order they were added to it.
+		static constexpr int backgroundLayer = 0;
+		static constexpr int defaultLayer = 1;
+
+		Drawable() : serial(nextSerial.fetch_add(1, std::memory_order_relaxed)) {}
 		Drawable(const Drawable& rect) = delete;
 		Drawable(Drawable&& rect) = delete;
 		virtual ~Drawable();
 
 		//Prevents all changes to the drawable (transformations, resizings, recolorings etc.) until the lock is released with unlock(). 
-		void lock() {
-			mtx.lock();
+		//"site" is where the lock is attributed to by the LockProfiler.
+		void lock(const std::source_location& site = std::source_location::current()) {
+			mtx.lock(site);
 		}
 
 		//When called, all changes to the drawable are allowed again.
@@ -34,12 +111,14 @@ namespace ts {
 			drawMeMtx.lock();
 			drawMe = false;
 			drawMeMtx.unlock();
+			requestRedraw();
 		}
 
 		void show() {
 			drawMeMtx.lock();
 			drawMe = true;
 			drawMeMtx.unlock();
+			requestRedraw();
 		}
 
 		bool isShown() {
@@ -49,6 +128,32 @@ namespace ts {
 			return temp;
 		}
 
+		/* Draws this drawable on "layer", in front of everything that is already on it. Only touches this drawable's old and new layer. */
+		void setLayer(int layer);
+
+		int getLayer();
+
+		/** Moves the drawable with "velocity" (pixels per second) and "acceleration" (pixels per second²) and rotates it by "angularVelocity" (degrees per second).
+		* The rendering thread integrates all moving drawables at once every frame. While the drawable is moving, the motion owns its position
+		* and rotation and overrides transformations, and its getters return the position of the last sync (see syncMotion).*/
+		void setMotion(sf::Vector2f velocity, sf::Vector2f acceleration = sf::Vector2f(), float angularVelocity = 0.0f);
+
+		/* Stops moving where the drawable is right now. The final position and rotation are written back. */
+		void stopMotion();
+
+		/* Writes the current position and rotation of a moving drawable back, so that its getters return them. Returns the whole state. */
+		ts::MotionState syncMotion();
+
+		/* ONLY CALL IN RENDERER WITH THE DRAWABLE LOCKED, AFTER swapBuffers! Moves the front buffer to "state". */
+		void writeMotionToFront(const ts::MotionState& state) {
+			if (frontTransformable == nullptr) {
+				return;
+			}
+			frontTransformable->setPosition(state.position);
+			frontTransformable->setRotation(state.rotation);
+			frontBounds = frontTransformable->getTransform().transformRect(frontLocalBounds);
+		}
+
 		bool isEqualTo(ts::Drawable& drawable) {
 			return this->drawable == drawable.accessDrawable();
 		}
@@ -61,10 +166,31 @@ namespace ts {
 		/*Call this from the renderer to apply commonand costly changes in the Rendering thread(prevents blocking of drawing)
 		Override this in derived classes and add the actual functionality there. */
 		virtual void applyChanges() {
-			addedAsChanged = false;
+			addedAsChanged.store(false, std::memory_order_release);
+			changedSinceSnapshot.store(true, std::memory_order_release);
+		}
+
+		bool isQueuedForChanges() {
+			return addedAsChanged.load(std::memory_order_acquire);
+		}
+
+		uint64_t getSerial() {
+			return serial;
+		}
+		/** ONLY CALL IN RENDERER WITH THE DRAWABLE LOCKED! Copies the current state into the front buffer and returns it.
+		* Override this in derived classes by calling writeFrontBuffer with the concrete sf object.*/
+		virtual sf::Drawable* swapBuffers() = 0;
+
+		//Only valid after swapBuffers was called.
+		sf::Shape* accessFrontShape() {
+			return frontShape;
+		}
+
+		/** ONLY CALL IN RENDERER WITH THE DRAWABLE LOCKED, AFTER swapBuffers! Writes the state between the last two completed ticks into the front buffer
+		* ("alpha" = 0: second to last tick, 1: last tick). Returns true if the front buffer was changed. Drawables without interpolation return false.*/
+		virtual bool interpolate(uint64_t latestTick, float alpha) {
+			return false;
 		}
-		/** ONLY CALL IN RENDERER! If you call it from anywhere else, it is not thread-synced*/
-		virtual void draw();
 	};
 
 	class Shape : public Drawable {
@@ -74,6 +200,9 @@ namespace ts {
 
 		void initShapeAfterConstruction(sf::Shape* shape) {
 			this->shape = shape;
+			//where the shape starts, counts as committed before the first tick
+			tickStates[0] = TickState{ 0, sf::Vector2f(actualX, actualY), getActualSize() };
+			tickStateCount = 1;
 			initDrawableAfterConstruction(shape);
 		}
 		/**
@@ -87,7 +216,34 @@ namespace ts {
 		bool positionChanged = false, colorChanged = false;
 
 		sf::Color actualColor;
-		std::mutex actualDataMtx;
+		ProfiledMutex actualDataMtx{ "Shape::actualDataMtx" };
+
+		//Transformations of the last ticks that changed this shape, oldest first, labeled with the tick that made them.
+		//Recorded by the setters in the thread that makes the change, read by the rendering thread to interpolate. Guarded by actualDataMtx.
+		//Three are enough: the tick that is still running and the last two completed ones.
+		struct TickState {
+			uint64_t tick;
+			sf::Vector2f position;
+			sf::Vector2f size;//width and height for rects, radius in x for circles
+		};
+		static constexpr int tickStateCapacity = 3;
+		TickState tickStates[tickStateCapacity];
+		int tickStateCount = 0;
+		//Set while the front buffer shows an interpolated or held back state. Only touched by the rendering thread.
+		bool frontInterpolated = false;
+		/* Call with actualDataMtx locked after every change of the position or size. */
+		void recordTickState();
+
+		void readTransform(sf::Vector2f& position, float& rotation) override;
+		void writeTransform(sf::Vector2f position, float rotation) override;
+
+		//Overridden by shapes that have a size which can be interpolated
+		virtual sf::Vector2f getActualSize() {
+			return sf::Vector2f(actualWidth, actualHeight);
+		}
+		virtual void writeFrontSize(sf::Vector2f size) {}
+		//Call with actualDataMtx locked. Sets the actual size and the size of the back buffer.
+		virtual void writeActualSize(sf::Vector2f size) {}
 
 	public:
 		void applyChanges() override {
@@ -106,12 +262,19 @@ namespace ts {
 			actualDataMtx.unlock();
 		}
 
+		bool interpolate(uint64_t latestTick, float alpha) override;
+
+		//ONLY CALL IN RENDERER WITH THE DRAWABLE LOCKED! Reads and writes the values animated by tweens, in the order of the property (see ts::TweenProperty).
+		void readTweenValue(TweenProperty property, float* value);
+		void writeTweenValue(TweenProperty property, const float* value);
+
 
 		void transform(float x, float y) {
 			actualDataMtx.lock();
 			actualX = x;
 			actualY = y;
 			positionChanged = true;
+			recordTickState();
 			prepareApplyingChanges();
 			actualDataMtx.unlock();
 		}
@@ -160,6 +323,7 @@ namespace ts {
 			shape->setOutlineColor(color);
 			shape->setOutlineThickness(thickness);
 			mtx.unlock();
+			requestRedraw();
 		}
 
 		sf::Color getColor() {
@@ -211,6 +375,16 @@ namespace ts {
 			return this;
 		}
 
+		Rect* setLayer(int layer) {
+			Drawable::setLayer(layer);
+			return this;
+		}
+
+		Rect* setMotion(sf::Vector2f velocity, sf::Vector2f acceleration = sf::Vector2f(), float angularVelocity = 0.0f) {
+			Drawable::setMotion(velocity, acceleration, angularVelocity);
+			return this;
+		}
+
 		sf::Vector2f getSize() {
 			mtx.lock();
 			sf::Vector2f temp(actualWidth, actualHeight);
@@ -218,6 +392,11 @@ namespace ts {
 			return temp;
 		}
 
+		sf::Drawable* swapBuffers() override {
+			writeFrontBuffer(*rect);
+			return frontBuffer;
+		}
+
 		void applyChanges() {
 			Shape::applyChanges();
 			actualDataMtx.lock();
@@ -228,11 +407,22 @@ namespace ts {
 			actualDataMtx.unlock();
 		}
 
+		void writeFrontSize(sf::Vector2f size) override {
+			static_cast<sf::RectangleShape*>(frontBuffer)->setSize(size);
+		}
+
+		void writeActualSize(sf::Vector2f size) override {
+			actualWidth = size.x;
+			actualHeight = size.y;
+			rect->setSize(size);
+		}
+
 		void resize(float width, float height) {
 			actualDataMtx.lock();
 			actualWidth = width;
 			actualHeight = height;
 			sizeChanged = true;
+			recordTickState();
 			prepareApplyingChanges();
 			actualDataMtx.unlock();
 		}
@@ -266,6 +456,7 @@ namespace ts {
 			mtx.lock();
 			line->setSize(sf::Vector2f(line->getSize().x, thickness));
 			mtx.unlock();
+			requestRedraw();
 			return this;
 		}
 
@@ -290,6 +481,7 @@ namespace ts {
 			line->setRotation(rot);
 			line->setPosition(x1, y1);
 			mtx.unlock();
+			requestRedraw();
 			return this;
 		}
 
@@ -297,8 +489,24 @@ namespace ts {
 			mtx.lock();
 			line->setFillColor(color);
 			mtx.unlock();
+			requestRedraw();
 			return this;
 		}
+
+		Line* setLayer(int layer) {
+			Drawable::setLayer(layer);
+			return this;
+		}
+
+		Line* setMotion(sf::Vector2f velocity, sf::Vector2f acceleration = sf::Vector2f(), float angularVelocity = 0.0f) {
+			Drawable::setMotion(velocity, acceleration, angularVelocity);
+			return this;
+		}
+
+		sf::Drawable* swapBuffers() override {
+			writeFrontBuffer(*line);
+			return frontBuffer;
+		}
 	};
 
 	class Circle : public Shape {
@@ -337,6 +545,16 @@ namespace ts {
 			Shape::addTexture(texturePath, repeat);
 			return this;
 		}
+
+		Circle* setLayer(int layer) {
+			Drawable::setLayer(layer);
+			return this;
+		}
+
+		Circle* setMotion(sf::Vector2f velocity, sf::Vector2f acceleration = sf::Vector2f(), float angularVelocity = 0.0f) {
+			Drawable::setMotion(velocity, acceleration, angularVelocity);
+			return this;
+		}
 	protected:
 		float actualRadius = 0;
 		bool radiusChanged = false;
@@ -345,6 +563,7 @@ namespace ts {
 			actualDataMtx.lock();
 			actualRadius = radius;
 			radiusChanged = true;
+			recordTickState();
 			prepareApplyingChanges();
 			actualDataMtx.unlock();
 			return this;
@@ -357,6 +576,19 @@ namespace ts {
 			return temp;
 		}
 
+		sf::Vector2f getActualSize() override {
+			return sf::Vector2f(actualRadius, actualRadius);
+		}
+
+		void writeFrontSize(sf::Vector2f size) override {
+			static_cast<sf::CircleShape*>(frontBuffer)->setRadius(size.x);
+		}
+
+		void writeActualSize(sf::Vector2f size) override {
+			actualRadius = size.x;
+			circle->setRadius(size.x);
+		}
+
 		void applyChanges() {
 			Shape::applyChanges();
 			actualDataMtx.lock();
@@ -365,6 +597,11 @@ namespace ts {
 			}
 			actualDataMtx.unlock();
 		}
+
+		sf::Drawable* swapBuffers() override {
+			writeFrontBuffer(*circle);
+			return frontBuffer;
+		}
 	};
 
 	class Text : public Drawable {
@@ -433,6 +670,7 @@ namespace ts {
 			mtx.lock();
 			text->setFont(*font);
 			mtx.unlock();
+			requestRedraw();
 			return this;
 		}
 
@@ -441,6 +679,7 @@ namespace ts {
 			mtx.lock();
 			text->setFillColor(color);
 			mtx.unlock();
+			requestRedraw();
 			return this;
 		}
 
@@ -448,6 +687,7 @@ namespace ts {
 			mtx.lock();
 			text->setString(string);
 			mtx.unlock();
+			requestRedraw();
 			return this;
 		}
 
@@ -455,6 +695,17 @@ namespace ts {
 			mtx.lock();
 			text->setCharacterSize(characterSize);
 			mtx.unlock();
+			requestRedraw();
+			return this;
+		}
+
+		Text* setLayer(int layer) {
+			Drawable::setLayer(layer);
+			return this;
+		}
+
+		Text* setMotion(sf::Vector2f velocity, sf::Vector2f acceleration = sf::Vector2f(), float angularVelocity = 0.0f) {
+			Drawable::setMotion(velocity, acceleration, angularVelocity);
 			return this;
 		}
 
@@ -462,9 +713,15 @@ namespace ts {
 			mtx.lock();
 			text->setPosition(x, y);
 			mtx.unlock();
+			requestRedraw();
 			return this;
 		}
 
+		sf::Drawable* swapBuffers() override {
+			writeFrontBuffer(*text);
+			return frontBuffer;
+		}
+
 	private:
 		//loaded in main thread because loading a font is not incredibly costly and I can't be bothered to put it into the Rendering thread like texture loading
 		sf::Font* loadFont(std::string fontPath);
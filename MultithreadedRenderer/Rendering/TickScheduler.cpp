@@ -0,0 +1,76 @@
+#include "TickScheduler.hpp"
+#include <algorithm>
+
+TickScheduler::TickScheduler(double ticksPerSecond, unsigned int maxCatchUpTicks) {
+	setTickRate(ticksPerSecond, maxCatchUpTicks);
+	start();
+}
+
+void TickScheduler::start() {
+	lastUpdate = Clock::now();
+	accumulator = Clock::duration::zero();
+	currentDeadline = lastUpdate + getTickInterval();
+}
+
+TickScheduler::Clock::duration TickScheduler::getTickInterval() {
+	statisticsMtx.lock();
+	Clock::duration out = tickInterval;
+	statisticsMtx.unlock();
+	return out;
+}
+
+void TickScheduler::setTickRate(double ticksPerSecond, unsigned int maxCatchUpTicks) {
+	statisticsMtx.lock();
+	tickInterval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / ticksPerSecond));
+	this->maxCatchUpTicks = std::max(1u, maxCatchUpTicks);
+	statisticsMtx.unlock();
+}
+
+TickScheduler::Clock::time_point TickScheduler::getNextDeadline() {
+	return lastUpdate + (getTickInterval() - accumulator);
+}
+
+unsigned int TickScheduler::takeDueTicks() {
+	Clock::time_point now = Clock::now();
+	accumulator += now - lastUpdate;
+	lastUpdate = now;
+
+	statisticsMtx.lock();
+	Clock::duration tickInterval = this->tickInterval;
+	int64_t due = accumulator / tickInterval;
+	if (due > (int64_t)maxCatchUpTicks) {//can't catch up anymore, continue from now instead of running ticks back to back forever
+		statistics.droppedTicks += due - maxCatchUpTicks;
+		accumulator -= (due - maxCatchUpTicks) * tickInterval;
+		due = maxCatchUpTicks;
+	}
+	statisticsMtx.unlock();
+
+	//the oldest due tick was due "accumulator - interval" ago
+	currentDeadline = now - (accumulator - tickInterval);
+	accumulator -= due * tickInterval;
+	return (unsigned int)due;
+}
+
+void TickScheduler::recordTick(Clock::time_point started, Clock::time_point finished) {
+	int64_t duration = std::chrono::duration_cast<std::chrono::microseconds>(finished - started).count();
+	int64_t lateness = std::chrono::duration_cast<std::chrono::microseconds>(started - currentDeadline).count();
+	statisticsMtx.lock();
+	Clock::duration tickInterval = this->tickInterval;
+	statistics.ticks++;
+	statistics.lastTickDuration = duration;
+	statistics.totalTickDuration += duration;
+	statistics.maxTickDuration = std::max(statistics.maxTickDuration, duration);
+	statistics.maxLateness = std::max(statistics.maxLateness, lateness);
+	if (finished - started > tickInterval) {
+		statistics.overruns++;
+	}
+	statisticsMtx.unlock();
+	currentDeadline += tickInterval;
+}
+
+TickStatistics TickScheduler::getStatistics() {
+	statisticsMtx.lock();
+	TickStatistics out = statistics;
+	statisticsMtx.unlock();
+	return out;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <chrono>
+#include <mutex>
+#include <cstdint>
+
+//Measurements of the ticks executed by a TickScheduler. All times in microseconds.
+struct TickStatistics {
+	uint64_t ticks = 0;
+	//ticks whose callback took longer than one tick interval
+	uint64_t overruns = 0;
+	//ticks that were skipped because more than maxCatchUpTicks were due at once
+	uint64_t droppedTicks = 0;
+	int64_t lastTickDuration = 0;
+	int64_t maxTickDuration = 0;
+	int64_t totalTickDuration = 0;
+	//how late a tick started after its deadline
+	int64_t maxLateness = 0;
+};
+
+/** Fixed timestep scheduling with an accumulator: every tick stands for exactly one tick interval of game time.
+* If ticks were missed (e.g. because a callback took too long), up to maxCatchUpTicks are executed back to back, the rest are dropped and counted.
+* Not threadsafe except for getStatistics(), getTickInterval() and setTickRate(), only the thread that runs the ticks should call the rest.*/
+class TickScheduler {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	TickScheduler(double ticksPerSecond, unsigned int maxCatchUpTicks);
+
+	/* Starts counting time from now. */
+	void start();
+
+	/* Point in time when the next tick is due */
+	Clock::time_point getNextDeadline();
+
+	/* Adds the time that passed since the last call to the accumulator and returns how many ticks have to be executed now. */
+	unsigned int takeDueTicks();
+
+	/* Call after every executed tick with its start and end time. */
+	void recordTick(Clock::time_point started, Clock::time_point finished);
+
+	/* Takes effect at the next call of takeDueTicks. */
+	void setTickRate(double ticksPerSecond, unsigned int maxCatchUpTicks);
+
+	TickStatistics getStatistics();
+
+	Clock::duration getTickInterval();
+
+private:
+	Clock::duration tickInterval;
+	unsigned int maxCatchUpTicks;
+	Clock::duration accumulator = Clock::duration::zero();
+	Clock::time_point lastUpdate;
+	//deadline of the tick that is executed next, for measuring lateness
+	Clock::time_point currentDeadline;
+
+	TickStatistics statistics;
+	std::mutex statisticsMtx;//also guards the tick rate
+};
@@ -0,0 +1,296 @@
+#include "Tween.hpp"
+#include "ThreadSafeObjects.hpp"
+#include <algorithm>
+#include <cmath>
+
+//Tween descriptions----------------------------------------------------------------------------------------------------------------------------
+
+ts::Tween ts::Tween::move(ts::Shape* target, float x, float y, sf::Time duration) {
+	Tween tween;
+	tween.target = target;
+	tween.property = TweenProperty::Position;
+	tween.endValue[0] = x;
+	tween.endValue[1] = y;
+	tween.duration = duration.asSeconds();
+	return tween;
+}
+
+ts::Tween ts::Tween::resize(ts::Shape* target, float width, float height, sf::Time duration) {
+	Tween tween;
+	tween.target = target;
+	tween.property = TweenProperty::Size;
+	tween.endValue[0] = width;
+	tween.endValue[1] = height;
+	tween.duration = duration.asSeconds();
+	return tween;
+}
+
+ts::Tween ts::Tween::radius(ts::Shape* target, float radius, sf::Time duration) {
+	return resize(target, radius, radius, duration);
+}
+
+ts::Tween ts::Tween::recolor(ts::Shape* target, sf::Color color, sf::Time duration) {
+	Tween tween;
+	tween.target = target;
+	tween.property = TweenProperty::Color;
+	tween.endValue[0] = color.r;
+	tween.endValue[1] = color.g;
+	tween.endValue[2] = color.b;
+	tween.endValue[3] = color.a;
+	tween.duration = duration.asSeconds();
+	return tween;
+}
+
+ts::Tween ts::Tween::fade(ts::Shape* target, sf::Uint8 alpha, sf::Time duration) {
+	Tween tween;
+	tween.target = target;
+	tween.property = TweenProperty::Alpha;
+	tween.endValue[0] = alpha;
+	tween.duration = duration.asSeconds();
+	return tween;
+}
+
+static float bounceOut(float t) {
+	if (t < 1.0f / 2.75f) {
+		return 7.5625f * t * t;
+	}
+	if (t < 2.0f / 2.75f) {
+		t -= 1.5f / 2.75f;
+		return 7.5625f * t * t + 0.75f;
+	}
+	if (t < 2.5f / 2.75f) {
+		t -= 2.25f / 2.75f;
+		return 7.5625f * t * t + 0.9375f;
+	}
+	t -= 2.625f / 2.75f;
+	return 7.5625f * t * t + 0.984375f;
+}
+
+float ts::ease(Easing easing, float t) {
+	constexpr float pi = 3.14159265f;
+	switch (easing) {
+	case Easing::Linear:
+		return t;
+	case Easing::QuadIn:
+		return t * t;
+	case Easing::QuadOut:
+		return t * (2.0f - t);
+	case Easing::QuadInOut:
+		return t < 0.5f ? 2.0f * t * t : -1.0f + (4.0f - 2.0f * t) * t;
+	case Easing::CubicIn:
+		return t * t * t;
+	case Easing::CubicOut: {
+		float u = t - 1.0f;
+		return u * u * u + 1.0f;
+	}
+	case Easing::CubicInOut: {
+		if (t < 0.5f) {
+			return 4.0f * t * t * t;
+		}
+		float u = 2.0f * t - 2.0f;
+		return 0.5f * u * u * u + 1.0f;
+	}
+	case Easing::SineIn:
+		return 1.0f - std::cos(t * pi / 2.0f);
+	case Easing::SineOut:
+		return std::sin(t * pi / 2.0f);
+	case Easing::SineInOut:
+		return 0.5f * (1.0f - std::cos(t * pi));
+	case Easing::BackOut: {//overshoots a bit before settling
+		constexpr float s = 1.70158f;
+		float u = t - 1.0f;
+		return u * u * ((s + 1.0f) * u + s) + 1.0f;
+	}
+	case Easing::BounceOut:
+		return bounceOut(t);
+	}
+	return t;
+}
+
+//Engine---------------------------------------------------------------------------------------------------------------------------------------
+
+uint64_t TweenEngine::add(const ts::Tween& tween, uint64_t targetSerial) {
+	Command command;
+	command.tween = tween;
+	command.id = nextId.fetch_add(1, std::memory_order_relaxed);
+	command.targetSerial = targetSerial;
+	if (commands.tryPush(command) == false) {
+		overflowMtx.lock();
+		overflowCommands.push_back(command);
+		overflowMtx.unlock();
+		overflowed.store(true, std::memory_order_release);
+	}
+	return command.id;
+}
+
+void TweenEngine::cancel(uint64_t tweenId) {
+	Command command;
+	command.id = tweenId;
+	command.cancel = true;
+	if (commands.tryPush(command) == false) {
+		overflowMtx.lock();
+		overflowCommands.push_back(command);
+		overflowMtx.unlock();
+		overflowed.store(true, std::memory_order_release);
+	}
+}
+
+void TweenEngine::execute(Command& command, double now, std::unordered_set<uint64_t>& cancelled) {
+	if (command.cancel == true) {
+		cancelled.insert(command.id);
+		return;
+	}
+	ActiveTween tween{ command.tween, command.id, command.targetSerial, 0.0, false };
+	liveIds.insert(command.id);
+	if (command.tween.predecessor != 0 && liveIds.count(command.tween.predecessor) != 0) {
+		followers[command.tween.predecessor].push_back(tween);
+	}
+	else {
+		activate(tween, now);
+	}
+}
+
+void TweenEngine::activate(ActiveTween tween, double now) {
+	tween.start = now + tween.tween.delay;
+	tween.started = false;
+	active.push_back(tween);
+}
+
+void TweenEngine::removeFollowers(uint64_t id) {
+	auto it = followers.find(id);
+	if (it == followers.end()) {
+		return;
+	}
+	std::vector<ActiveTween> removed = std::move(it->second);
+	followers.erase(it);
+	for (size_t i = 0; i < removed.size(); i++) {
+		liveIds.erase(removed[i].id);
+		removeFollowers(removed[i].id);
+	}
+}
+
+void TweenEngine::cancelAll(const std::unordered_set<uint64_t>& ids) {
+	if (ids.empty() == true) {
+		return;
+	}
+	//keeps the order of the others, later tweens have to stay after earlier ones so that the one added last wins
+	active.erase(std::remove_if(active.begin(), active.end(), [&ids](const ActiveTween& tween) { return ids.count(tween.id) != 0; }), active.end());
+	for (auto& [predecessor, waiting] : followers) {
+		waiting.erase(std::remove_if(waiting.begin(), waiting.end(), [&ids](const ActiveTween& tween) { return ids.count(tween.id) != 0; }), waiting.end());
+	}
+	for (uint64_t id : ids) {
+		liveIds.erase(id);
+		removeFollowers(id);
+	}
+}
+
+void TweenEngine::finish(uint64_t id, double now) {
+	liveIds.erase(id);
+	auto it = followers.find(id);
+	if (it == followers.end()) {
+		return;
+	}
+	std::vector<ActiveTween> next = std::move(it->second);
+	followers.erase(it);
+	for (size_t i = 0; i < next.size(); i++) {
+		activate(next[i], now);
+	}
+}
+
+void TweenEngine::update(double now, const std::unordered_map<uint64_t, size_t>& deletedTargets) {
+	//apply commands----------------------------------------------------------------------------------------------------------
+	std::unordered_set<uint64_t> cancelled;
+	Command command;
+	size_t drained = 0;
+	while (drained < commands.getCapacity() && commands.tryPop(command) == true) {
+		execute(command, now, cancelled);
+		drained++;
+	}
+	if (overflowed.exchange(false, std::memory_order_acq_rel) == true) {
+		overflowMtx.lock();
+		std::vector<Command> overflow = std::move(overflowCommands);
+		overflowCommands.clear();
+		overflowMtx.unlock();
+		for (size_t i = 0; i < overflow.size(); i++) {
+			execute(overflow[i], now, cancelled);
+		}
+	}
+
+	//tweens of deleted shapes must not touch them anymore
+	if (deletedTargets.empty() == false) {
+		for (size_t i = 0; i < active.size(); i++) {
+			if (deletedTargets.count(active[i].targetSerial) != 0) {
+				cancelled.insert(active[i].id);
+			}
+		}
+		for (auto& [predecessor, waiting] : followers) {
+			for (size_t i = 0; i < waiting.size(); i++) {
+				if (deletedTargets.count(waiting[i].targetSerial) != 0) {
+					cancelled.insert(waiting[i].id);
+				}
+			}
+		}
+	}
+	cancelAll(cancelled);
+
+	//evaluate all running tweens---------------------------------------------------------------------------------------------
+	float value[4];
+	//finished tweens are compacted out while iterating, so the ones that stay keep their order (the one added last wins)
+	size_t kept = 0;
+	for (size_t i = 0; i < active.size(); i++) {
+		ActiveTween& running = active[i];
+		ts::Tween& tween = running.tween;
+		if (now < running.start) {//delayed
+			if (kept != i) {
+				active[kept] = std::move(running);
+			}
+			kept++;
+			continue;
+		}
+		if (running.started == false) {
+			if (tween.hasStartValue == false) {
+				tween.target->readTweenValue(tween.property, tween.startValue);
+				tween.hasStartValue = true;
+			}
+			running.started = true;
+		}
+
+		bool finished = false;
+		float progress = 1.0f;
+		if (tween.duration > 0.0f) {
+			progress = (float)((now - running.start) / tween.duration);
+			while (progress >= 1.0f && tween.loops != 0) {//the next repetition starts where this one ended
+				if (tween.loops > 0) {
+					tween.loops--;
+				}
+				running.start += tween.duration;
+				if (tween.yoyo == true) {
+					std::swap(tween.startValue, tween.endValue);
+				}
+				progress = (float)((now - running.start) / tween.duration);
+			}
+		}
+		if (progress >= 1.0f) {
+			progress = 1.0f;
+			finished = true;
+		}
+
+		float eased = ts::ease(tween.easing, progress);
+		for (int k = 0; k < 4; k++) {
+			value[k] = tween.startValue[k] + (tween.endValue[k] - tween.startValue[k]) * eased;
+		}
+		tween.target->writeTweenValue(tween.property, value);
+
+		if (finished == true) {
+			finish(running.id, now);//may append to active, those are evaluated in this pass as well
+		}
+		else {
+			if (kept != i) {
+				active[kept] = std::move(running);
+			}
+			kept++;
+		}
+	}
+	active.resize(kept);
+	activeCount.store(active.size());
+}
\ No newline at end of file
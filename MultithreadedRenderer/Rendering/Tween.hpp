@@ -0,0 +1,155 @@
+#pragma once
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include "SFML/Graphics.hpp"
+#include "MPSCQueue.hpp"
+
+namespace ts {
+	class Shape;
+
+	//How the progress of a tween (0-1) is mapped to the progress of its value.
+	enum class Easing {
+		Linear,
+		QuadIn, QuadOut, QuadInOut,
+		CubicIn, CubicOut, CubicInOut,
+		SineIn, SineOut, SineInOut,
+		BackOut,
+		BounceOut
+	};
+
+	enum class TweenProperty {
+		Position,//x, y
+		Size,//width, height. Circles use the width as radius.
+		Color,//r, g, b, a
+		Alpha//a
+	};
+
+	/** Description of an animation of one property of a shape. Build it with move/resize/recolor/fade and the builder functions and pass it to Renderer::addTween.
+	* The animation runs in the rendering thread, the thread that added it does not have to do anything per frame.*/
+	struct Tween {
+		ts::Shape* target = nullptr;
+		TweenProperty property = TweenProperty::Position;
+		float endValue[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		//if hasStartValue is false, the tween starts from the value the shape has when the tween starts
+		float startValue[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		bool hasStartValue = false;
+		float duration = 0.0f;//seconds
+		float delay = 0.0f;//seconds
+		Easing easing = Easing::Linear;
+		//how often the tween is repeated after the first run, -1 = forever
+		int loops = 0;
+		//if true, every repetition runs back to where the last one started
+		bool yoyo = false;
+		//0 = start right away, otherwise the id of the tween after which this one starts
+		uint64_t predecessor = 0;
+
+		static Tween move(ts::Shape* target, float x, float y, sf::Time duration);
+		static Tween resize(ts::Shape* target, float width, float height, sf::Time duration);
+		static Tween radius(ts::Shape* target, float radius, sf::Time duration);
+		static Tween recolor(ts::Shape* target, sf::Color color, sf::Time duration);
+		static Tween fade(ts::Shape* target, sf::Uint8 alpha, sf::Time duration);
+
+		Tween& setEasing(Easing easing) {
+			this->easing = easing;
+			return *this;
+		}
+
+		Tween& setDelay(sf::Time delay) {
+			this->delay = delay.asSeconds();
+			return *this;
+		}
+
+		Tween& setLoops(int loops, bool yoyo) {
+			this->loops = loops;
+			this->yoyo = yoyo;
+			return *this;
+		}
+
+		//Values in the order of the property (see TweenProperty), colors from 0 to 255
+		Tween& setStartValue(float a, float b = 0.0f, float c = 0.0f, float d = 0.0f) {
+			startValue[0] = a; startValue[1] = b; startValue[2] = c; startValue[3] = d;
+			hasStartValue = true;
+			return *this;
+		}
+
+		/* Starts this tween when the tween with "tweenId" has finished. Starts right away if that one is already finished. */
+		Tween& startAfter(uint64_t tweenId) {
+			predecessor = tweenId;
+			return *this;
+		}
+	};
+
+	float ease(Easing easing, float progress);
+}
+
+/** Evaluates all running tweens in one pass over a compact array, once per frame in the rendering thread.
+* Other threads only push commands into a lock-free queue, which is drained at the start of every update.*/
+class TweenEngine {
+public:
+	/* Can be called from any thread. Returns the id of the tween (never 0). "targetSerial" is the serial of the target drawable. */
+	uint64_t add(const ts::Tween& tween, uint64_t targetSerial);
+
+	/* Can be called from any thread. Also cancels all tweens that were chained after it. */
+	void cancel(uint64_t tweenId);
+
+	/** ONLY CALL IN RENDERER WITH ALL DRAWABLES LOCKED! Drops the tweens of "deletedTargets" (keyed by serial),
+	* then writes the value of every running tween at "now" (seconds on the Renderer's frame clock) into its target.*/
+	void update(double now, const std::unordered_map<uint64_t, size_t>& deletedTargets);
+
+	/* Position the next command will get. Every command pushed before this call is below it. Can be called from any thread. */
+	size_t getCommandPosition() {
+		return commands.getEnqueuePosition();
+	}
+
+	/* All commands below this position were executed. Only call in the rendering thread. */
+	size_t getExecutedPosition() {
+		return commands.getDequeuePosition();
+	}
+
+	/* Running and delayed tweens, without the ones that wait for a predecessor. Can be called from any thread. */
+	size_t getActiveCount() {
+		return activeCount.load();
+	}
+
+private:
+	struct Command {
+		ts::Tween tween;
+		uint64_t id = 0;
+		uint64_t targetSerial = 0;
+		bool cancel = false;
+	};
+	struct ActiveTween {
+		ts::Tween tween;
+		uint64_t id;
+		uint64_t targetSerial;
+		double start;//frame clock seconds
+		bool started;
+	};
+
+	MPSCQueue<Command, 16384> commands;
+	//commands that didn't fit into the queue
+	std::vector<Command> overflowCommands;
+	std::mutex overflowMtx;
+	std::atomic<bool> overflowed = false;
+	std::atomic<uint64_t> nextId = 1;
+
+	//Only touched by the rendering thread
+	std::vector<ActiveTween> active;
+	//tweens waiting for the tween with the key to finish
+	std::unordered_map<uint64_t, std::vector<ActiveTween>> followers;
+	//ids of all tweens in "active" and "followers"
+	std::unordered_set<uint64_t> liveIds;
+	std::atomic<size_t> activeCount = 0;
+
+	void execute(Command& command, double now, std::unordered_set<uint64_t>& cancelled);
+	void activate(ActiveTween tween, double now);
+	//Removes the tweens with these ids and everything chained after them
+	void cancelAll(const std::unordered_set<uint64_t>& ids);
+	void removeFollowers(uint64_t id);
+	//Starts the tweens that waited for "id"
+	void finish(uint64_t id, double now);
+};
\ No newline at end of file
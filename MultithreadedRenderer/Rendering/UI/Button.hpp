@@ -6,6 +6,8 @@ public:
     Button(ts::Rect* rect, ts::Text* text) : rect(rect), text(text) {
         text->centerToRect(rect);
     }
+    //"rect" and "text" belong to the caller
+    virtual ~Button() {}
 
     /**
      * @brief Call this with every iteration of the even thread in order to activate button functionality. No Functionality in base class.
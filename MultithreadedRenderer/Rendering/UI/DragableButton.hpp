@@ -13,6 +13,15 @@ public:
         spaceBetweenLines = calculateSpaceBetweenLines();
     }
 
+    //deletes the drawables it created itself
+    ~DragableButton() {
+        delete dragablePanel;
+        delete slider;
+        for (ts::Rect* line : lines) {
+            delete line;
+        }
+    }
+
 private:
 	void createDragablePanel() { 
         //hardcoded bounds for dragable rect
@@ -0,0 +1,293 @@
+#include "Rendering/Renderer.hpp"
+#include "Rendering/SoftwareRasterizer.hpp"
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <functional>
+
+/* Microbenchmark of the ts:: mutation API: ns per call of transform, setColor, resize, setRadius, setString and the getters.
+* Every operation is measured in three modes:
+*   single     one thread calls it, nothing is drawn
+*   render     one thread calls it while the rendering thread draws frames back to back
+*   producers  "--threads" threads call it at once on their own share of the objects while the rendering thread draws
+* Usage: MutationBenchmark [--backend sfml|software] [--objects 1000] [--ops 1000000] [--threads N] [--op name] [--mode name] [--out file.json]
+* Run it with MultithreadedRenderer as working directory, the font of ts::Text is loaded from Rendering/recources there.*/
+
+struct Options {
+    std::string backend = "software";
+    unsigned int objects = 1000;
+    unsigned int ops = 1000000;//per thread
+    unsigned int threads = std::max(2u, std::thread::hardware_concurrency() / 2);
+    std::string op;
+    std::string mode;
+    std::string out;
+};
+
+struct Objects {
+    std::vector<ts::Rect*> rects;
+    std::vector<ts::Circle*> circles;
+    std::vector<ts::Text*> texts;
+};
+
+//Keeps the compiler from dropping the getters
+static std::atomic<float> sink = 0.0f;
+
+struct Operation {
+    const char* name;
+    //Calls the operation "count" times on the objects from "first" to "first" + "range"
+    std::function<void(Objects&, unsigned int first, unsigned int range, unsigned int count)> run;
+};
+
+static std::vector<Operation> createOperations() {
+    static const std::string strings[8] = { "0", "1234", "Score: 100", "Score: 1000", "Health 87/100", "Paused", "Level 12", "" };
+    return {
+        { "Shape::transform", [](Objects& objects, unsigned int first, unsigned int range, unsigned int count) {
+            for (unsigned int i = 0; i < count; i++) {
+                objects.rects[first + i % range]->transform((float)(i & 1023), (float)(i & 511));
+            }
+        } },
+        { "Shape::setColor", [](Objects& objects, unsigned int first, unsigned int range, unsigned int count) {
+            for (unsigned int i = 0; i < count; i++) {
+                objects.rects[first + i % range]->setColor(sf::Color((sf::Uint8)i, 128, 64));
+            }
+        } },
+        { "Rect::resize", [](Objects& objects, unsigned int first, unsigned int range, unsigned int count) {
+            for (unsigned int i = 0; i < count; i++) {
+                objects.rects[first + i % range]->resize((float)(10 + (i & 31)), 20.0f);
+            }
+        } },
+        { "Circle::setRadius", [](Objects& objects, unsigned int first, unsigned int range, unsigned int count) {
+            for (unsigned int i = 0; i < count; i++) {
+                objects.circles[first + i % range]->setRadius((float)(5 + (i & 15)));
+            }
+        } },
+        { "Text::setString", [](Objects& objects, unsigned int first, unsigned int range, unsigned int count) {
+            for (unsigned int i = 0; i < count; i++) {
+                objects.texts[first + i % range]->setString(strings[i & 7]);
+            }
+        } },
+        { "Shape::getX", [](Objects& objects, unsigned int first, unsigned int range, unsigned int count) {
+            float sum = 0.0f;
+            for (unsigned int i = 0; i < count; i++) {
+                sum += objects.rects[first + i % range]->getX();
+            }
+            sink.store(sum, std::memory_order_relaxed);
+        } },
+        { "Shape::getPosition", [](Objects& objects, unsigned int first, unsigned int range, unsigned int count) {
+            float sum = 0.0f;
+            for (unsigned int i = 0; i < count; i++) {
+                sum += objects.rects[first + i % range]->getPosition().y;
+            }
+            sink.store(sum, std::memory_order_relaxed);
+        } },
+        { "Shape::getColor", [](Objects& objects, unsigned int first, unsigned int range, unsigned int count) {
+            float sum = 0.0f;
+            for (unsigned int i = 0; i < count; i++) {
+                sum += objects.rects[first + i % range]->getColor().r;
+            }
+            sink.store(sum, std::memory_order_relaxed);
+        } },
+        { "Rect::getSize", [](Objects& objects, unsigned int first, unsigned int range, unsigned int count) {
+            float sum = 0.0f;
+            for (unsigned int i = 0; i < count; i++) {
+                sum += objects.rects[first + i % range]->getSize().x;
+            }
+            sink.store(sum, std::memory_order_relaxed);
+        } },
+        { "Circle::getRadius", [](Objects& objects, unsigned int first, unsigned int range, unsigned int count) {
+            float sum = 0.0f;
+            for (unsigned int i = 0; i < count; i++) {
+                sum += objects.circles[first + i % range]->getRadius();
+            }
+            sink.store(sum, std::memory_order_relaxed);
+        } },
+    };
+}
+
+/** Owns the headless Renderer. It is initialized and stepped from its own thread, because that thread has to own the
+* OpenGL context of the offscreen target. Draws frames back to back while "drawing" is set.*/
+class RenderThread {
+public:
+    RenderThread(const std::string& backend) {
+        thread = std::thread([this, backend]() {
+            PROFILE_THREAD("Rendering thread");
+            SoftwareRasterizer* rasterizer = nullptr;
+            if (backend == "software") {
+                rasterizer = new SoftwareRasterizer(1920, 1080);
+            }
+            Renderer::initHeadless(1920, 1080, rasterizer);
+            initialized.store(true);
+            while (quit.load() == false) {
+                if (drawing.load() == true) {
+                    Renderer::stepFrame();
+                    frames.fetch_add(1);
+                }
+                else {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }
+            Renderer::stepFrame();//frees the drawables deleted meanwhile
+        });
+        while (initialized.load() == false) {
+            std::this_thread::yield();
+        }
+    }
+
+    ~RenderThread() {
+        quit.store(true);
+        thread.join();
+    }
+
+    std::atomic<bool> drawing = false;
+    std::atomic<uint64_t> frames = 0;
+
+private:
+    std::thread thread;
+    std::atomic<bool> initialized = false;
+    std::atomic<bool> quit = false;
+};
+
+struct Result {
+    const char* op;
+    const char* mode;
+    unsigned int threads;
+    double nsPerOp;//mean over the threads
+    double mopsPerSecond;//all threads together
+    uint64_t frames;//drawn while measuring
+};
+
+static Result measure(const Operation& operation, const char* mode, unsigned int threadCount, bool draw, Objects& objects, RenderThread& renderer, const Options& options) {
+    //a short run first, so that every object is queued and allocated once before measuring
+    operation.run(objects, 0, options.objects, options.objects);
+
+    renderer.drawing.store(draw);
+    uint64_t framesBefore = renderer.frames.load();
+    std::vector<double> seconds(threadCount);
+    std::atomic<unsigned int> ready = 0;
+    std::vector<std::thread> producers;
+    unsigned int range = std::max(1u, options.objects / threadCount);
+    for (unsigned int t = 0; t < threadCount; t++) {
+        producers.push_back(std::thread([&, t]() {
+            //every producer has its own objects, so only the locks shared between objects and with the renderer are contended
+            unsigned int first = std::min(t * range, options.objects - range);
+            ready.fetch_add(1);
+            while (ready.load() < threadCount) {
+                std::this_thread::yield();
+            }
+            auto started = std::chrono::steady_clock::now();
+            operation.run(objects, first, range, options.ops);
+            seconds[t] = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        }));
+    }
+    for (std::thread& producer : producers) {
+        producer.join();
+    }
+    uint64_t frames = renderer.frames.load() - framesBefore;
+    renderer.drawing.store(false);
+
+    double nsPerOp = 0.0, longest = 0.0;
+    for (double time : seconds) {
+        nsPerOp += time * 1e9 / options.ops;
+        longest = std::max(longest, time);
+    }
+    return Result{ operation.name, mode, threadCount, nsPerOp / threadCount, longest > 0 ? (double)options.ops * threadCount / longest / 1e6 : 0.0, frames };
+}
+
+static bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--backend" && hasValue) {
+            options.backend = argv[++i];
+        }
+        else if (arg == "--objects" && hasValue) {
+            options.objects = std::max(1u, (unsigned int)std::stoul(argv[++i]));
+        }
+        else if (arg == "--ops" && hasValue) {
+            options.ops = std::max(1u, (unsigned int)std::stoul(argv[++i]));
+        }
+        else if (arg == "--threads" && hasValue) {
+            options.threads = std::max(1u, (unsigned int)std::stoul(argv[++i]));
+        }
+        else if (arg == "--op" && hasValue) {
+            options.op = argv[++i];
+        }
+        else if (arg == "--mode" && hasValue) {
+            options.mode = argv[++i];
+        }
+        else if (arg == "--out" && hasValue) {
+            options.out = argv[++i];
+        }
+        else {
+            std::cerr << "unknown argument '" << arg << "'\n"
+                << "usage: MutationBenchmark [--backend sfml|software] [--objects 1000] [--ops 1000000] [--threads N] [--op name] [--mode single|render|producers] [--out file.json]\n";
+            return false;
+        }
+    }
+    if (options.backend != "sfml" && options.backend != "software") {
+        std::cerr << "unknown backend '" << options.backend << "'\n";
+        return false;
+    }
+    options.threads = std::min(options.threads, options.objects);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (parseOptions(argc, argv, options) == false) {
+        return 1;
+    }
+    RenderThread renderer(options.backend);
+
+    Objects objects;
+    for (unsigned int i = 0; i < options.objects; i++) {
+        float x = (float)(i % 40) * 48.0f, y = (float)((i / 40) % 22) * 48.0f;
+        objects.rects.push_back((new ts::Rect(x, y, 20, 20))->setColor(sf::Color::Green));
+        objects.circles.push_back((new ts::Circle(x + 24, y, 10))->setColor(sf::Color::Red));
+        objects.texts.push_back(new ts::Text(x, y + 24, "0"));
+    }
+    //draws everything once, later frames only copy what changed
+    renderer.drawing.store(true);
+    while (renderer.frames.load() < 2) {
+        std::this_thread::yield();
+    }
+    renderer.drawing.store(false);
+
+    std::vector<Result> results;
+    for (const Operation& operation : createOperations()) {
+        if (options.op.empty() == false && options.op != operation.name) {
+            continue;
+        }
+        if (options.mode.empty() == true || options.mode == "single") {
+            results.push_back(measure(operation, "single", 1, false, objects, renderer, options));
+        }
+        if (options.mode.empty() == true || options.mode == "render") {
+            results.push_back(measure(operation, "render", 1, true, objects, renderer, options));
+        }
+        if (options.mode.empty() == true || options.mode == "producers") {
+            results.push_back(measure(operation, "producers", options.threads, true, objects, renderer, options));
+        }
+    }
+
+    std::ostringstream json;
+    json << "{\"backend\":\"" << options.backend << "\",\"hardware_threads\":" << std::thread::hardware_concurrency()
+        << ",\"objects\":" << options.objects << ",\"ops_per_thread\":" << options.ops << ",\"results\":[";
+    for (size_t i = 0; i < results.size(); i++) {
+        json << (i > 0 ? "," : "") << "\n{\"op\":\"" << results[i].op << "\",\"mode\":\"" << results[i].mode << "\",\"threads\":" << results[i].threads
+            << ",\"ns_per_op\":" << results[i].nsPerOp << ",\"mops_per_second\":" << results[i].mopsPerSecond << ",\"frames\":" << results[i].frames << "}";
+    }
+    json << "\n]}\n";
+
+    std::cout << json.str();
+    if (options.out.empty() == false) {
+        std::ofstream file(options.out);
+        file << json.str();
+    }
+
+    for (size_t i = 0; i < objects.rects.size(); i++) {
+        delete objects.rects[i];
+        delete objects.circles[i];
+        delete objects.texts[i];
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,363 @@
+#include "Rendering/Renderer.hpp"
+#include "Rendering/SoftwareRasterizer.hpp"
+#include "Rendering/PixelKernels.hpp"
+#include "Rendering/UI/DragableButton.hpp"
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <random>
+#include <cstring>
+
+/* Scene benchmark: every scene creates its drawables, runs headless for a fixed number of frames and is deleted again.
+* Usage: SceneBenchmark [--backend sfml|software] [--frames 300] [--warmup 10] [--count N] [--scene name] [--kernels] [--out file.json]
+* Run it with MultithreadedRenderer as working directory, resources are loaded from Rendering/recources there.
+* The results are written as JSON to stdout (and "--out"), so runs of different builds and backends can be compared.*/
+
+class Scene {
+public:
+    virtual ~Scene() {}
+    virtual const char* getName() = 0;
+    //objects if "--count" isn't given
+    virtual unsigned int getDefaultCount() = 0;
+    virtual void setup(unsigned int count) = 0;
+    //called before every frame, like the game thread would
+    virtual void update(unsigned int frame) {}
+    virtual void teardown() = 0;
+
+protected:
+    std::mt19937 random{ 42 };
+
+    float randomFloat(float min, float max) {
+        return std::uniform_real_distribution<float>(min, max)(random);
+    }
+    sf::Color randomColor() {
+        return sf::Color((sf::Uint8)random(), (sf::Uint8)random(), (sf::Uint8)random());
+    }
+    template <typename T>
+    void deleteAll(std::vector<T*>& objects) {
+        for (T* object : objects) {
+            delete object;
+        }
+        objects.clear();
+    }
+};
+
+class StaticRects : public Scene {
+public:
+    const char* getName() override { return "static_rects"; }
+    unsigned int getDefaultCount() override { return 10000; }
+    void setup(unsigned int count) override {
+        for (unsigned int i = 0; i < count; i++) {
+            rects.push_back((new ts::Rect(randomFloat(0, 1900), randomFloat(0, 1060), 20, 20))->setColor(randomColor()));
+        }
+    }
+    void teardown() override { deleteAll(rects); }
+
+private:
+    std::vector<ts::Rect*> rects;
+};
+
+class MovingCircles : public Scene {
+public:
+    const char* getName() override { return "moving_circles"; }
+    unsigned int getDefaultCount() override { return 5000; }
+    void setup(unsigned int count) override {
+        for (unsigned int i = 0; i < count; i++) {
+            circles.push_back((new ts::Circle(randomFloat(0, 1880), randomFloat(0, 1040), 20))->setColor(randomColor()));
+            velocities.push_back(sf::Vector2f(randomFloat(-5, 5), randomFloat(-5, 5)));
+        }
+    }
+    void update(unsigned int frame) override {
+        //moved through the mutation API every frame, so changes and snapshots are part of the measurement
+        for (size_t i = 0; i < circles.size(); i++) {
+            sf::Vector2f position = circles[i]->getPosition() + velocities[i];
+            if (position.x < 0 || position.x > 1880) {
+                velocities[i].x = -velocities[i].x;
+            }
+            if (position.y < 0 || position.y > 1040) {
+                velocities[i].y = -velocities[i].y;
+            }
+            circles[i]->transform(position.x, position.y);
+        }
+    }
+    void teardown() override {
+        deleteAll(circles);
+        velocities.clear();
+    }
+
+private:
+    std::vector<ts::Circle*> circles;
+    std::vector<sf::Vector2f> velocities;
+};
+
+class TexturedShapes : public Scene {
+public:
+    const char* getName() override { return "textured_shapes"; }
+    unsigned int getDefaultCount() override { return 4000; }
+    void setup(unsigned int count) override {
+        for (unsigned int i = 0; i < count; i++) {
+            if (i % 2 == 0) {
+                rects.push_back((new ts::Rect(randomFloat(0, 1860), randomFloat(0, 1020), 60, 60))->addTexture("Textures/container.jpg", false));
+            }
+            else {
+                circles.push_back((new ts::Circle(randomFloat(0, 1860), randomFloat(0, 1020), 30))->addTexture("Textures/awesomeface.png", false));
+            }
+        }
+    }
+    void teardown() override {
+        deleteAll(rects);
+        deleteAll(circles);
+    }
+
+private:
+    std::vector<ts::Rect*> rects;
+    std::vector<ts::Circle*> circles;
+};
+
+class Lines : public Scene {
+public:
+    const char* getName() override { return "lines"; }
+    unsigned int getDefaultCount() override { return 5000; }
+    void setup(unsigned int count) override {
+        for (unsigned int i = 0; i < count; i++) {
+            float x = randomFloat(0, 1920), y = randomFloat(0, 1080);
+            lines.push_back((new ts::Line(x, y, x + randomFloat(-100, 100), y + randomFloat(-100, 100)))->setColor(randomColor())->setThickness(3.0f));
+        }
+    }
+    void teardown() override { deleteAll(lines); }
+
+private:
+    std::vector<ts::Line*> lines;
+};
+
+class Texts : public Scene {
+public:
+    const char* getName() override { return "texts"; }
+    unsigned int getDefaultCount() override { return 1000; }
+    void setup(unsigned int count) override {
+        for (unsigned int i = 0; i < count; i++) {
+            texts.push_back((new ts::Text(randomFloat(0, 1800), randomFloat(0, 1050), "Text " + std::to_string(i)))->setColor(randomColor()));
+        }
+    }
+    void update(unsigned int frame) override {
+        //a few changing strings per frame, like counters in a HUD
+        for (size_t i = frame % 100; i < texts.size(); i += 100) {
+            texts[i]->setString("Frame " + std::to_string(frame));
+        }
+    }
+    void teardown() override { deleteAll(texts); }
+
+private:
+    std::vector<ts::Text*> texts;
+};
+
+class Churn : public Scene {
+public:
+    const char* getName() override { return "churn"; }
+    unsigned int getDefaultCount() override { return 5000; }
+    void setup(unsigned int count) override {
+        for (unsigned int i = 0; i < count; i++) {
+            rects.push_back(create());
+        }
+    }
+    void update(unsigned int frame) override {
+        //a tenth of the drawables is deleted and created again every frame
+        for (size_t i = 0; i < rects.size() / 10; i++) {
+            size_t index = (frame * 7919 + i * 104729) % rects.size();
+            delete rects[index];
+            rects[index] = create();
+        }
+    }
+    void teardown() override { deleteAll(rects); }
+
+private:
+    std::vector<ts::Rect*> rects;
+
+    ts::Rect* create() {
+        return (new ts::Rect(randomFloat(0, 1880), randomFloat(0, 1040), 40, 40))->setColor(randomColor());
+    }
+};
+
+class MixedUI : public Scene {
+public:
+    const char* getName() override { return "mixed_ui"; }
+    unsigned int getDefaultCount() override { return 200; }
+    void setup(unsigned int count) override {
+        //a grid of buttons, every tenth one a slider
+        for (unsigned int i = 0; i < count; i++) {
+            float x = (float)(i % 10) * 190.0f + 5.0f, y = (float)((i / 10) % 20) * 54.0f + 2.0f;
+            ts::Rect* rect = (new ts::Rect(x, y, 180, 50))->setColor(sf::Color(60, 60, 60));
+            ts::Text* text = (new ts::Text(x, y, "Button " + std::to_string(i)))->setCharacterSize(18);
+            rects.push_back(rect);
+            texts.push_back(text);
+            if (i % 10 == 0) {
+                buttons.push_back(new DragableButton(rect, text, 5, 2));
+            }
+            else {
+                buttons.push_back(new Button(rect, text));
+            }
+        }
+    }
+    void update(unsigned int frame) override {
+        for (Button* button : buttons) {
+            button->update();
+        }
+        //hovering highlights one button per frame
+        rects[(frame + rects.size() - 1) % rects.size()]->setColor(sf::Color(60, 60, 60));
+        rects[frame % rects.size()]->setColor(sf::Color(90, 90, 160));
+    }
+    void teardown() override {
+        deleteAll(buttons);
+        deleteAll(rects);
+        deleteAll(texts);
+    }
+
+private:
+    std::vector<Button*> buttons;
+    std::vector<ts::Rect*> rects;
+    std::vector<ts::Text*> texts;
+};
+
+struct Options {
+    std::string backend = "sfml";
+    unsigned int frames = 300;
+    unsigned int warmup = 10;
+    unsigned int count = 0;//0 = default of every scene
+    std::string scene;
+    bool kernels = false;
+    std::string out;
+};
+
+static double percentile(std::vector<double> sorted, double p) {
+    if (sorted.empty() == true) {
+        return 0.0;
+    }
+    std::sort(sorted.begin(), sorted.end());
+    return sorted[(size_t)(p * (sorted.size() - 1) + 0.5)];
+}
+
+static void runScene(Scene& scene, const Options& options, std::ostream& json) {
+    unsigned int count = options.count != 0 ? options.count : scene.getDefaultCount();
+    scene.setup(count);
+
+    std::vector<double> frameMs, updateMs;
+    double drawCalls = 0;
+    for (unsigned int frame = 0; frame < options.warmup + options.frames; frame++) {
+        auto started = std::chrono::steady_clock::now();
+        scene.update(frame);
+        auto updated = std::chrono::steady_clock::now();
+        Renderer::stepFrame();
+        auto drawn = std::chrono::steady_clock::now();
+        if (frame >= options.warmup) {//the first frames load textures and fonts
+            updateMs.push_back(std::chrono::duration<double, std::milli>(updated - started).count());
+            frameMs.push_back(std::chrono::duration<double, std::milli>(drawn - updated).count());
+            drawCalls += Renderer::getLastFrameDrawCalls();
+        }
+    }
+    scene.teardown();
+    Renderer::stepFrame();//lets the Renderer free the deleted drawables before the next scene
+
+    double mean = 0, updateMean = 0;
+    for (size_t i = 0; i < frameMs.size(); i++) {
+        mean += frameMs[i];
+        updateMean += updateMs[i];
+    }
+    size_t measured = std::max<size_t>(1, frameMs.size());
+    mean /= measured;
+    updateMean /= measured;
+
+    json << "{\"scene\":\"" << scene.getName() << "\",\"objects\":" << count << ",\"frames\":" << frameMs.size()
+        << ",\"frame_ms\":{\"mean\":" << mean << ",\"p50\":" << percentile(frameMs, 0.5) << ",\"p99\":" << percentile(frameMs, 0.99) << "}"
+        << ",\"update_ms_mean\":" << updateMean
+        << ",\"draw_calls_mean\":" << drawCalls / measured
+        << ",\"objects_per_second\":" << (mean > 0 ? count / (mean / 1000.0) : 0.0) << "}";
+}
+
+static bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--backend" && hasValue) {
+            options.backend = argv[++i];
+        }
+        else if (arg == "--frames" && hasValue) {
+            options.frames = (unsigned int)std::stoul(argv[++i]);
+        }
+        else if (arg == "--warmup" && hasValue) {
+            options.warmup = (unsigned int)std::stoul(argv[++i]);
+        }
+        else if (arg == "--count" && hasValue) {
+            options.count = (unsigned int)std::stoul(argv[++i]);
+        }
+        else if (arg == "--scene" && hasValue) {
+            options.scene = argv[++i];
+        }
+        else if (arg == "--out" && hasValue) {
+            options.out = argv[++i];
+        }
+        else if (arg == "--kernels") {
+            options.kernels = true;
+        }
+        else {
+            std::cerr << "unknown argument '" << arg << "'\n"
+                << "usage: SceneBenchmark [--backend sfml|software] [--frames 300] [--warmup 10] [--count N] [--scene name] [--kernels] [--out file.json]\n";
+            return false;
+        }
+    }
+    if (options.backend != "sfml" && options.backend != "software") {
+        std::cerr << "unknown backend '" << options.backend << "'\n";
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (parseOptions(argc, argv, options) == false) {
+        return 1;
+    }
+    SoftwareRasterizer* rasterizer = nullptr;
+    if (options.backend == "software") {
+        rasterizer = new SoftwareRasterizer(1920, 1080);
+    }
+    Renderer::initHeadless(1920, 1080, rasterizer);
+
+    std::vector<Scene*> scenes = { new StaticRects(), new MovingCircles(), new TexturedShapes(), new Lines(), new Texts(), new Churn(), new MixedUI() };
+    std::ostringstream json;
+    json << "{\"backend\":\"" << options.backend << "\",\"threads\":" << std::thread::hardware_concurrency()
+        << ",\"instruction_set\":\"" << PixelKernels::getName(PixelKernels::getInstructionSet()) << "\",\"scenes\":[";
+    bool first = true;
+    for (Scene* scene : scenes) {
+        if (options.scene.empty() == false && options.scene != scene->getName()) {
+            continue;
+        }
+        if (first == false) {
+            json << ",";
+        }
+        first = false;
+        json << "\n";
+        runScene(*scene, options, json);
+    }
+    json << "\n]";
+
+    if (options.kernels == true) {
+        json << ",\"kernels\":[";
+        std::vector<PixelKernels::BenchmarkResult> results = PixelKernels::benchmark();
+        for (size_t i = 0; i < results.size(); i++) {
+            json << (i > 0 ? "," : "") << "\n{\"kernel\":\"" << results[i].kernel << "\",\"instruction_set\":\"" << PixelKernels::getName(results[i].set)
+                << "\",\"mpixels_per_second\":" << results[i].megapixelsPerSecond << "}";
+        }
+        json << "\n]";
+    }
+    json << "}\n";
+
+    std::cout << json.str();
+    if (options.out.empty() == false) {
+        std::ofstream file(options.out);
+        file << json.str();
+    }
+    for (Scene* scene : scenes) {
+        delete scene;
+    }
+    return 0;
+}
\ No newline at end of file